@@ -1,7 +1,15 @@
+#include "parser/batch.h"
+#include "parser/codegen.h"
 #include "parser/dfa.h"
 #include "parser/parser.h"
+#include "parser/static_table.h"
 
+#include <filesystem>
+#include <format>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <span>
 
 using namespace epr;
 
@@ -12,8 +20,70 @@ E -> E + T | E - T | T
 T -> T * F | T / F | F
 F -> ( E ) | n)"sv; // Change here
 
-int main() {
-  auto parser = Parser(Grammar::from_str(grammar_sv));
+// Built during compilation; a conflict in grammar_sv fails the build.
+constexpr auto compiled_table = make_static_table<grammar_sv>();
+
+int main(int argc, char *argv[]) {
+  ParserOptions options{};
+  std::filesystem::path header_path{};
+  bool use_static_table = false;
+  bool batch = false;
+  auto mode = OutputMode::Value;
+  const auto args = std::span(argv + 1, argc - 1);
+  for (usize idx = 0; idx < args.size(); ++idx) {
+    const std::string_view arg = args[idx];
+    if (arg == "--lalr")
+      options.construction = Construction::Lalr1;
+    else if (arg == "--minimal-lr1")
+      options.construction = Construction::MinimalLr1;
+    else if (arg == "--compress")
+      options.compress = true;
+    else if (arg == "--cache" && idx + 1 < args.size())
+      options.cache_dir = args[++idx];
+    else if (arg == "--eliminate-unit-rules")
+      options.eliminate_unit_rules = true;
+    else if (arg == "--trace")
+      mode = OutputMode::Trace;
+    else if (arg == "--ast")
+      mode = OutputMode::Ast;
+    else if (arg == "--batch")
+      batch = true;
+    else if (arg == "--static")
+      use_static_table = true;
+    else if (arg == "--emit-header" && idx + 1 < args.size())
+      header_path = args[++idx];
+    else if (arg == "--threads" && idx + 1 < args.size())
+      options.threads = std::stoul(args[++idx]);
+  }
+
+  // Batch output is one result per line, so the stages stay quiet.
+  if (batch)
+    options.verbose = false;
+
+  auto grammar = Grammar::from_str(grammar_sv);
+  auto parser = use_static_table
+                    ? Parser(std::move(grammar), compiled_table.view(), options)
+                    : Parser(std::move(grammar), options);
+  if (!header_path.empty()) {
+    std::ofstream out(header_path);
+    out << emit_header(parser.tables->grammar, parser.tables->view);
+    if (!out.flush()) {
+      std::cerr << std::format("Cannot write '{}'\n", header_path.string());
+      return 1;
+    }
+    std::cerr << std::format("Wrote '{}'\n", header_path.string());
+    return 0;
+  }
+
+  if (batch) {
+    const std::string buffer(std::istreambuf_iterator<char>(std::cin), {});
+    ThreadPool pool(options.threads);
+    for (const auto &result : evaluate_lines(*parser.tables, buffer, pool))
+      std::cout << result.to_string() << '\n';
+    std::cout.flush();
+    return 0;
+  }
+
   std::cerr << "Enter a line of expression, or 'q' to quit.\n" << std::endl;
   for (std::string line; std::getline(std::cin, line);) {
     if (line.empty())
@@ -21,7 +91,7 @@ int main() {
     if (line == "q")
       break;
     try {
-      parser.parse_src(line);
+      parser.parse_src(line, mode);
     } catch (const std::exception &e) {
       std::cerr << e.what() << '\n' << std::endl;
       continue;
@@ -0,0 +1,204 @@
+#include "parser/analysis.h"
+
+#include <algorithm>
+#include <format>
+
+namespace epr {
+
+TerminalSet::TerminalSet(const u32 terminal_count):
+    words_((terminal_count + 63) / 64) {}
+
+bool TerminalSet::unite(const TerminalSet &rhs) {
+  u64 changed = 0;
+  for (usize idx = 0; idx < words_.size(); ++idx) {
+    const u64 old = words_[idx];
+    words_[idx] |= rhs.words_[idx];
+    changed |= old ^ words_[idx];
+  }
+  return changed != 0;
+}
+
+bool TerminalSet::intersects(const TerminalSet &rhs) const {
+  for (usize idx = 0; idx < words_.size(); ++idx)
+    if (words_[idx] & rhs.words_[idx])
+      return true;
+  return false;
+}
+
+void TerminalSet::clear() {
+  std::ranges::fill(words_, 0);
+}
+
+bool TerminalSet::empty() const {
+  return std::ranges::all_of(words_, [](const u64 word) {
+    return word == 0;
+  });
+}
+
+usize TerminalSet::size() const {
+  usize ret = 0;
+  for (const auto word : words_)
+    ret += std::popcount(word);
+  return ret;
+}
+
+GrammarAnalysis::GrammarAnalysis(
+    const std::vector<Production> &production_list, const SymbolTable &symbols,
+    const Symbol start_symbol
+):
+    nullable(symbols.size()),
+    first_sets(symbols.size(), TerminalSet(symbols.terminal_count())),
+    follow_sets(symbols.size(), TerminalSet(symbols.terminal_count())) {
+  const auto symbol_count = symbols.size();
+
+  std::vector<std::vector<u32>> productions_of(symbol_count);
+  for (u32 idx = 0; idx < production_list.size(); ++idx)
+    productions_of[production_list[idx].first.id].push_back(idx);
+
+  { // nullable: each production counts down its not-yet-nullable symbols
+    std::vector<usize> remaining(production_list.size());
+    std::vector<std::vector<u32>> occurrences(symbol_count);
+    std::vector<u32> worklist{Symbol::empty_symbol().id};
+    nullable[Symbol::empty_symbol().id] = true;
+
+    auto mark_nullable = [&](const u32 id) {
+      if (!nullable[id]) {
+        nullable[id] = true;
+        worklist.push_back(id);
+      }
+    };
+
+    for (u32 idx = 0; idx < production_list.size(); ++idx) {
+      const auto &[lhs, rhs] = production_list[idx];
+      const bool has_terminal =
+          std::ranges::any_of(rhs, [](const Symbol &symbol) {
+            return symbol.type == Symbol::Terminator &&
+                   symbol != Symbol::empty_symbol();
+          });
+      if (has_terminal)
+        continue;
+      remaining[idx] = rhs.size();
+      for (const auto &symbol : rhs)
+        occurrences[symbol.id].push_back(idx);
+      if (rhs.empty())
+        mark_nullable(lhs.id);
+    }
+
+    while (!worklist.empty()) {
+      const auto id = worklist.back();
+      worklist.pop_back();
+      for (const auto idx : occurrences[id])
+        if (--remaining[idx] == 0)
+          mark_nullable(production_list[idx].first.id);
+    }
+  }
+
+  // FIRST
+  for (u32 id = 1; id < symbols.terminal_count(); ++id)
+    first_sets[id].insert(id);
+
+  std::vector<std::vector<u32>> first_graph(symbol_count);
+  for (const auto &[lhs, rhs] : production_list)
+    for (const auto &symbol : rhs) {
+      if (symbol.type == Symbol::NonTerminator)
+        first_graph[lhs.id].push_back(symbol.id);
+      if (!nullable[symbol.id])
+        break;
+    }
+
+  for (const auto &component : strongly_connected_components(first_graph)) {
+    const bool recursive = is_recursive(component, first_graph);
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (const auto id : component)
+        for (const auto idx : productions_of[id])
+          for (const auto &symbol : production_list[idx].second) {
+            changed |= first_sets[id].unite(first_sets[symbol.id]);
+            if (!nullable[symbol.id])
+              break;
+          }
+      changed &= recursive;
+    }
+  }
+
+  // FOLLOW: FIRST of the trailing context is seeded directly, FOLLOW(lhs)
+  // flows into FOLLOW(symbol) along the graph edges.
+  follow_sets[start_symbol.id].insert(Symbol::end_symbol().id);
+
+  std::vector<std::vector<u32>> follow_graph(symbol_count);
+  for (const auto &[lhs, rhs] : production_list)
+    for (usize pos = 0; pos < rhs.size(); ++pos) {
+      const auto &symbol = rhs[pos];
+      if (symbol.type != Symbol::NonTerminator)
+        continue;
+      const auto rest = std::span(rhs).subspan(pos + 1);
+      if (first(rest, follow_sets[symbol.id]) && symbol != lhs)
+        follow_graph[symbol.id].push_back(lhs.id);
+    }
+
+  for (const auto &component : strongly_connected_components(follow_graph)) {
+    const bool recursive = is_recursive(component, follow_graph);
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (const auto id : component)
+        for (const auto dependency : follow_graph[id])
+          changed |= follow_sets[id].unite(follow_sets[dependency]);
+      changed &= recursive;
+    }
+  }
+}
+
+bool GrammarAnalysis::first(
+    const std::span<const Symbol> str, TerminalSet &out
+) const {
+  for (const auto &symbol : str) {
+    if (symbol.type == Symbol::Terminator && symbol.id != 0) {
+      out.insert(symbol.id);
+      return false;
+    }
+    out.unite(first_sets[symbol.id]);
+    if (!nullable[symbol.id])
+      return false;
+  }
+  return true;
+}
+
+void GrammarAnalysis::first(
+    const std::span<const Symbol> str, const Symbol &lookahead,
+    TerminalSet &out
+) const {
+  if (first(str, out))
+    out.insert(lookahead.id);
+}
+
+std::string GrammarAnalysis::to_string(const SymbolTable &symbols) const {
+  auto set_to_string = [&](const TerminalSet &set, const bool with_empty) {
+    std::string buf = "{ ";
+    set.for_each([&](const u32 id) {
+      buf.append(symbols.at(id).to_string(symbols)).append(", ");
+    });
+    if (with_empty)
+      buf.append(Symbol::empty_symbol().to_string(symbols)).append(", ");
+    if (buf.size() > 2)
+      buf.pop_back(), buf.pop_back();
+    buf.append(" }");
+    return buf;
+  };
+
+  std::string buf;
+  for (u32 id = symbols.terminal_count(); id < symbols.size(); ++id)
+    buf.append(std::format(
+        "FIRST( {} ) = {}\n", symbols.at(id).to_string(symbols),
+        set_to_string(first_sets[id], nullable[id])
+    ));
+  for (u32 id = symbols.terminal_count(); id < symbols.size(); ++id)
+    buf.append(std::format(
+        "FOLLOW( {} ) = {}\n", symbols.at(id).to_string(symbols),
+        set_to_string(follow_sets[id], false)
+    ));
+  if (!buf.empty())
+    buf.pop_back();
+  return buf;
+}
+
+} // namespace epr
@@ -0,0 +1,84 @@
+#pragma once
+
+#ifndef EPR_PARSER_ANALYSIS_H
+#  define EPR_PARSER_ANALYSIS_H
+
+#  include "parser/symbol.h"
+#  include "util/all.h"
+
+#  include <bit>
+#  include <span>
+#  include <string>
+#  include <utility>
+#  include <vector>
+
+namespace epr {
+
+using Production = std::pair<Symbol, std::vector<Symbol>>;
+
+// Dense bitset over terminal ids.
+class TerminalSet {
+  std::vector<u64> words_{};
+
+public:
+  TerminalSet() = default;
+
+  explicit TerminalSet(u32 terminal_count);
+
+  bool operator==(const TerminalSet &rhs) const = default;
+
+  void insert(u32 id) {
+    words_[id / 64] |= u64{1} << (id % 64);
+  }
+
+  [[nodiscard]] bool contains(u32 id) const {
+    return words_[id / 64] >> (id % 64) & 1;
+  }
+
+  // Returns whether any bit was added.
+  bool unite(const TerminalSet &rhs);
+
+  [[nodiscard]] bool intersects(const TerminalSet &rhs) const;
+
+  void clear();
+
+  [[nodiscard]] bool empty() const;
+
+  [[nodiscard]] usize size() const;
+
+  template<typename F>
+  void for_each(F &&f) const {
+    for (usize idx = 0; idx < words_.size(); ++idx)
+      for (u64 word = words_[idx]; word; word &= word - 1)
+        f(static_cast<u32>(idx * 64 + std::countr_zero(word)));
+  }
+};
+
+// Nullable, FIRST and FOLLOW for every symbol, indexed by symbol id. The sets
+// never contain the empty symbol; nullability is tracked separately.
+struct GrammarAnalysis {
+  std::vector<bool> nullable{};
+  std::vector<TerminalSet> first_sets{};
+  std::vector<TerminalSet> follow_sets{};
+
+  GrammarAnalysis() = default;
+
+  GrammarAnalysis(
+      const std::vector<Production> &production_list,
+      const SymbolTable &symbols, Symbol start_symbol
+  );
+
+  // Unites FIRST(str) into `out` and returns whether `str` is nullable.
+  bool first(std::span<const Symbol> str, TerminalSet &out) const;
+
+  // Unites FIRST(str lookahead) into `out`.
+  void first(
+      std::span<const Symbol> str, const Symbol &lookahead, TerminalSet &out
+  ) const;
+
+  [[nodiscard]] std::string to_string(const SymbolTable &symbols) const;
+};
+
+} // namespace epr
+
+#endif // !EPR_PARSER_ANALYSIS_H
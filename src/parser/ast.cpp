@@ -0,0 +1,107 @@
+#include "parser/ast.h"
+
+namespace epr {
+
+Ast::Ast(std::pmr::memory_resource *resource):
+    symbol(resource), production(resource), child_begin(resource),
+    child_end(resource), span(resource), children(resource) {}
+
+void Ast::reserve(const usize nodes) {
+  symbol.reserve(nodes);
+  production.reserve(nodes);
+  child_begin.reserve(nodes);
+  child_end.reserve(nodes);
+  span.reserve(nodes);
+  children.reserve(nodes);
+}
+
+u32 Ast::add_token(const u32 symbol_id, const SourceSpan token_span) {
+  const auto node = static_cast<u32>(size());
+  const auto at = static_cast<u32>(children.size());
+  symbol.push_back(symbol_id);
+  production.push_back(NO_RULE);
+  child_begin.push_back(at);
+  child_end.push_back(at);
+  span.push_back(token_span);
+  return node;
+}
+
+u32 Ast::add_reduction(
+    const u32 symbol_id, const u32 rule, const std::span<const u32> rhs,
+    const u32 at
+) {
+  const auto node = static_cast<u32>(size());
+  symbol.push_back(symbol_id);
+  production.push_back(rule);
+  child_begin.push_back(static_cast<u32>(children.size()));
+  children.insert(children.end(), rhs.begin(), rhs.end());
+  child_end.push_back(static_cast<u32>(children.size()));
+  span.push_back(
+      rhs.empty() ? SourceSpan{at, at}
+                  : SourceSpan{span[rhs.front()].begin, span[rhs.back()].end}
+  );
+  return node;
+}
+
+std::string
+Ast::to_string(const SymbolTable &symbols, const std::string_view src) const {
+  // Depth-first with an explicit stack, since trees of long inputs are deep.
+  constexpr auto CLOSE = NO_RULE;
+  std::string buf{};
+  std::vector<u32> pending{root};
+  while (!pending.empty()) {
+    const auto node = pending.back();
+    pending.pop_back();
+    if (node == CLOSE) {
+      buf.push_back(')');
+      continue;
+    }
+    if (!buf.empty())
+      buf.push_back(' ');
+    if (production[node] == NO_RULE) {
+      const auto [begin, end] = span[node];
+      buf.append(src.substr(begin, end - begin));
+      continue;
+    }
+    buf.append("(").append(symbols.name(symbols.at(symbol[node])));
+    pending.push_back(CLOSE);
+    const auto kids = children_of(node);
+    pending.insert(pending.end(), kids.rbegin(), kids.rend());
+  }
+  return buf;
+}
+
+AstBuilder::AstBuilder(
+    const Grammar &grammar, const std::span<const u32> input,
+    const std::span<const SourceSpan> spans,
+    std::pmr::memory_resource *resource
+):
+    grammar_(&grammar), input_(input), spans_(spans), ast_(resource) {
+  // Tokens and a node per reduction: a few per token for an expression
+  // grammar.
+  ast_.reserve(input.size() * 4 + 1);
+}
+
+SemanticActions<u32> AstBuilder::actions() {
+  SemanticActions<u32> ret{};
+  ret.on_shift = [this](const usize input_idx) {
+    const auto token_span = spans_[input_idx];
+    cursor_ = token_span.end;
+    return ast_.add_token(input_[input_idx], token_span);
+  };
+  const auto &production_list = grammar_->production_list;
+  for (u32 rule = 0; rule < production_list.size(); ++rule)
+    ret.on_reduce.emplace_back([this, rule](const std::span<u32> rhs) {
+      return ast_.add_reduction(
+          grammar_->production_list[rule].first.id, rule, rhs, cursor_
+      );
+    });
+  return ret;
+}
+
+Ast AstBuilder::finish(const u32 root) && {
+  ast_.root = root;
+  return std::move(ast_);
+}
+
+} // namespace epr
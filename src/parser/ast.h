@@ -0,0 +1,88 @@
+#pragma once
+
+#ifndef EPR_PARSER_AST_H
+#  define EPR_PARSER_AST_H
+
+#  include "parser/grammar.h"
+#  include "parser/semantic_actions.h"
+#  include "simple_lexer/token.h"
+#  include "util/all.h"
+
+#  include <memory_resource>
+#  include <span>
+#  include <string>
+#  include <string_view>
+
+namespace epr {
+
+// A syntax tree as parallel arrays indexed by node. A node is a token or a
+// reduction; the children of a reduction are the range [child_begin,
+// child_end) of `children`, which holds node indices. All arrays draw on one
+// memory resource, meant to be a per-parse arena such as a
+// std::pmr::monotonic_buffer_resource, so the tree is freed with it at once.
+struct Ast {
+  static constexpr u32 NO_RULE = ~u32{};
+
+  std::pmr::vector<u32> symbol;     // symbol id
+  std::pmr::vector<u32> production; // rule, or NO_RULE for a token
+  std::pmr::vector<u32> child_begin;
+  std::pmr::vector<u32> child_end;
+  std::pmr::vector<SourceSpan> span;
+  std::pmr::vector<u32> children;
+  u32 root{};
+
+  explicit Ast(std::pmr::memory_resource *resource);
+
+  void reserve(usize nodes);
+
+  [[nodiscard]] usize size() const {
+    return symbol.size();
+  }
+
+  [[nodiscard]] std::span<const u32> children_of(const u32 node) const {
+    return std::span(children).subspan(
+        child_begin[node], child_end[node] - child_begin[node]
+    );
+  }
+
+  u32 add_token(u32 symbol_id, SourceSpan token_span);
+
+  // A reduction by `rule` over the nodes `rhs`; an empty one sits at `at`.
+  u32 add_reduction(
+      u32 symbol_id, u32 rule, std::span<const u32> rhs, u32 at
+  );
+
+  // As an S-expression, with tokens written as their source text.
+  [[nodiscard]] std::string
+  to_string(const SymbolTable &symbols, std::string_view src) const;
+};
+
+// Fills an Ast from a parse of `input`, through SemanticActions whose values
+// are node indices. Every rule gets a node, but rules that the table bypasses
+// (see ParsingTable::eliminate_unit_reductions()) never reduce.
+class AstBuilder {
+  const Grammar *grammar_;
+  std::span<const u32> input_; // terminal ids
+  std::span<const SourceSpan> spans_;
+  Ast ast_;
+  u32 cursor_{}; // end of the last token, where an empty reduction sits
+
+public:
+  AstBuilder(
+      const Grammar &grammar, std::span<const u32> input,
+      std::span<const SourceSpan> spans, std::pmr::memory_resource *resource
+  );
+
+  // The actions refer back to the builder.
+  AstBuilder(const AstBuilder &rhs) = delete;
+
+  AstBuilder &operator=(const AstBuilder &rhs) = delete;
+
+  [[nodiscard]] SemanticActions<u32> actions();
+
+  [[nodiscard]] Ast finish(u32 root) &&;
+};
+
+} // namespace epr
+
+#endif // !EPR_PARSER_AST_H
@@ -0,0 +1,83 @@
+#include "parser/batch.h"
+
+#include <format>
+#include <memory>
+#include <stdexcept>
+
+namespace epr {
+
+std::string BatchResult::to_string() const {
+  switch (status) {
+    case Status::Ok:
+      return std::to_string(value);
+    case Status::SyntaxError:
+      return std::format("error: syntax error at token {}", error_position);
+    default:
+      return std::format("error: {}", message);
+  }
+}
+
+EvalSession::EvalSession(const ParserTables &tables):
+    tables_(&tables), actions_(arithmetic_actions(tables.grammar, lexer_)) {}
+
+BatchResult EvalSession::evaluate(const std::string_view src) {
+  BatchResult result{};
+  std::span<const u32> input{};
+  try {
+    lexer_.load_src(src);
+    input = lexer_.lex_terminals(tables_->terminals);
+  } catch (const std::runtime_error &e) {
+    result.status = BatchResult::Status::LexError;
+    result.message = e.what();
+    return result;
+  }
+
+  try {
+    if (const auto value = tables_->evaluate(input, actions_, value_context_)) {
+      result.value = *value;
+      return result;
+    }
+  } catch (const std::runtime_error &e) {
+    result.status = BatchResult::Status::EvalError;
+    result.message = e.what();
+    return result;
+  }
+  result.status = BatchResult::Status::SyntaxError;
+  result.error_position =
+      tables_->recognize(input, context_).error_positions.front();
+  return result;
+}
+
+std::vector<BatchResult> evaluate_batch(
+    const ParserTables &tables, const std::span<const std::string_view> inputs,
+    ThreadPool &pool
+) {
+  std::vector<BatchResult> results(inputs.size());
+  std::vector<std::unique_ptr<EvalSession>> sessions{};
+  for (usize worker = 0; worker < pool.size(); ++worker)
+    sessions.push_back(std::make_unique<EvalSession>(tables));
+  pool.parallel_for(inputs.size(), [&](const usize idx, const usize worker) {
+    results[idx] = sessions[worker]->evaluate(inputs[idx]);
+  });
+  return results;
+}
+
+std::vector<BatchResult> evaluate_lines(
+    const ParserTables &tables, const std::string_view buffer,
+    ThreadPool &pool
+) {
+  std::vector<std::string_view> lines{};
+  for (usize begin = 0; begin < buffer.size();) {
+    auto end = buffer.find('\n', begin);
+    if (end == std::string_view::npos)
+      end = buffer.size();
+    auto line = buffer.substr(begin, end - begin);
+    if (line.ends_with('\r'))
+      line.remove_suffix(1);
+    lines.push_back(line);
+    begin = end + 1;
+  }
+  return evaluate_batch(tables, lines, pool);
+}
+
+} // namespace epr
@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef EPR_PARSER_BATCH_H
+#  define EPR_PARSER_BATCH_H
+
+#  include "parser/parser.h"
+#  include "util/all.h"
+
+#  include <span>
+#  include <string>
+#  include <string_view>
+#  include <vector>
+
+namespace epr {
+
+// Outcome of one expression of a batch.
+struct BatchResult {
+  enum class Status : u8 { Ok, LexError, SyntaxError, EvalError };
+
+  Status status{};
+  i64 value{};             // when Ok
+  usize error_position{};  // token index of the first syntax error
+  std::string message{};   // why lexing or evaluation failed
+
+  [[nodiscard]] std::string to_string() const;
+};
+
+// What one thread needs to evaluate expression after expression with
+// arithmetic_actions(): a lexer, the parse contexts and the actions, bound to
+// the lexer. All of them are reused, so once their buffers have grown to fit
+// the inputs, evaluating one allocates nothing unless it fails.
+class EvalSession {
+  const ParserTables *tables_;
+  Lexer lexer_{};
+  ParseContext<> context_{};
+  ParseContext<i64> value_context_{};
+  SemanticActions<i64> actions_;
+
+public:
+  // Throws if the grammar has no arithmetic meaning.
+  explicit EvalSession(const ParserTables &tables);
+
+  // `actions_` refer to `lexer_`.
+  EvalSession(const EvalSession &rhs) = delete;
+
+  EvalSession &operator=(const EvalSession &rhs) = delete;
+
+  [[nodiscard]] BatchResult evaluate(std::string_view src);
+};
+
+// Evaluates every input, spread over `pool`. Each worker runs its own
+// EvalSession across the inputs it takes, and all of them share `tables`.
+// Results are in input order.
+[[nodiscard]] std::vector<BatchResult> evaluate_batch(
+    const ParserTables &tables, std::span<const std::string_view> inputs,
+    ThreadPool &pool
+);
+
+// evaluate_batch() over the lines of `buffer`. A final newline does not
+// start another line, and a '\r' before a newline is dropped.
+[[nodiscard]] std::vector<BatchResult> evaluate_lines(
+    const ParserTables &tables, std::string_view buffer, ThreadPool &pool
+);
+
+} // namespace epr
+
+#endif // !EPR_PARSER_BATCH_H
@@ -0,0 +1,76 @@
+#include "parser/closure.h"
+
+#include <algorithm>
+#include <span>
+
+namespace epr {
+
+ClosureTable::ClosureTable(
+    const std::vector<Production> &production_list,
+    const std::vector<std::vector<u32>> &productions_of,
+    const GrammarAnalysis &analysis, const SymbolTable &symbols
+):
+    templates(symbols.size()) {
+  const auto terminal_count = symbols.terminal_count();
+  const auto rule_count = production_list.size();
+
+  // FIRST and nullability of what follows the leading symbol of each rule.
+  std::vector<TerminalSet> tail_first(rule_count, TerminalSet(terminal_count));
+  std::vector<bool> tail_nullable(rule_count);
+  for (usize rule = 0; rule < rule_count; ++rule) {
+    const auto &rhs = production_list[rule].second;
+    if (!rhs.empty())
+      tail_nullable[rule] =
+          analysis.first(std::span(rhs).subspan(1), tail_first[rule]);
+  }
+
+  constexpr u32 ABSENT = ~u32{0};
+  std::vector<u32> entry_of(rule_count, ABSENT);
+  std::vector<u32> worklist{};
+
+  for (u32 id = terminal_count; id < symbols.size(); ++id) {
+    auto &entries = templates[id].entries;
+
+    auto entry = [&](const u32 rule) -> ClosureTemplate::Entry & {
+      if (entry_of[rule] == ABSENT) {
+        entry_of[rule] = static_cast<u32>(entries.size());
+        entries.push_back({rule, TerminalSet(terminal_count), false});
+      }
+      return entries[entry_of[rule]];
+    };
+
+    for (const auto rule : productions_of[id]) {
+      entry(rule).propagated = true;
+      worklist.push_back(rule);
+    }
+
+    while (!worklist.empty()) {
+      const auto rule = worklist.back();
+      worklist.pop_back();
+      const auto &rhs = production_list[rule].second;
+      if (rhs.empty() || rhs.front().type != Symbol::NonTerminator)
+        continue;
+
+      for (const auto next_rule : productions_of[rhs.front().id]) {
+        const bool is_new = entry_of[next_rule] == ABSENT;
+        auto &next = entry(next_rule);
+        // `entry()` may have grown `entries`, so look the source up again.
+        const auto &source = entries[entry_of[rule]];
+        bool changed = next.spontaneous.unite(tail_first[rule]);
+        if (tail_nullable[rule]) {
+          changed |= next.spontaneous.unite(source.spontaneous);
+          if (source.propagated && !next.propagated)
+            next.propagated = changed = true;
+        }
+        if (changed || is_new)
+          worklist.push_back(next_rule);
+      }
+    }
+
+    for (const auto &e : entries)
+      entry_of[e.rule] = ABSENT;
+    std::ranges::sort(entries, {}, &ClosureTemplate::Entry::rule);
+  }
+}
+
+} // namespace epr
@@ -0,0 +1,46 @@
+#pragma once
+
+#ifndef EPR_PARSER_CLOSURE_H
+#  define EPR_PARSER_CLOSURE_H
+
+#  include "parser/analysis.h"
+#  include "parser/symbol.h"
+#  include "util/all.h"
+
+#  include <vector>
+
+namespace epr {
+
+// The items B -> · γ that closing over a single non-terminal A adds, each
+// with the lookaheads that arise within the closure (spontaneous) and whether
+// the lookaheads of the item that brought in A also reach it (propagated).
+struct ClosureTemplate {
+  struct Entry {
+    u32 rule{};
+    TerminalSet spontaneous{};
+    bool propagated{};
+  };
+
+  std::vector<Entry> entries{}; // sorted by rule
+};
+
+// Closure templates of every non-terminal, indexed by symbol id.
+struct ClosureTable {
+  std::vector<ClosureTemplate> templates{};
+
+  ClosureTable() = default;
+
+  ClosureTable(
+      const std::vector<Production> &production_list,
+      const std::vector<std::vector<u32>> &productions_of,
+      const GrammarAnalysis &analysis, const SymbolTable &symbols
+  );
+
+  [[nodiscard]] const ClosureTemplate &operator[](const Symbol &symbol) const {
+    return templates[symbol.id];
+  }
+};
+
+} // namespace epr
+
+#endif // !EPR_PARSER_CLOSURE_H
@@ -0,0 +1,290 @@
+#include "parser/codegen.h"
+
+#include <algorithm>
+#include <format>
+#include <ranges>
+
+namespace epr {
+
+namespace {
+
+constexpr usize LINE_WIDTH = 80;
+
+[[nodiscard]] std::string_view uint_type(const u64 max) {
+  if (max <= 0xFF)
+    return "std::uint8_t";
+  if (max <= 0xFFFF)
+    return "std::uint16_t";
+  return "std::uint32_t";
+}
+
+[[nodiscard]] std::string quoted(const std::string &str) {
+  std::string ret = "\"";
+  for (const auto c : str) {
+    if (c == '"' || c == '\\')
+      ret.push_back('\\');
+    ret.push_back(c);
+  }
+  ret.push_back('"');
+  return ret;
+}
+
+// Appends `{a, b, ...}`. A list too long to finish the current line has its
+// items wrapped below `indent`, so that no line grows past LINE_WIDTH.
+void append_list(
+    std::string &buf, const std::vector<std::string> &items,
+    const usize indent
+) {
+  const auto line_start = buf.rfind('\n');
+  // Braces and the trailing ',' or ';'.
+  usize flat_width = buf.size() - (line_start + 1) + 3;
+  for (const auto &item : items)
+    flat_width += item.size() + 2;
+  if (flat_width <= LINE_WIDTH) {
+    buf.push_back('{');
+    for (usize idx = 0; idx < items.size(); ++idx)
+      buf.append(idx == 0 ? "" : ", ").append(items[idx]);
+    buf.push_back('}');
+    return;
+  }
+
+  buf.push_back('{');
+  auto column = LINE_WIDTH; // force a break before the first item
+  for (usize idx = 0; idx < items.size(); ++idx) {
+    const auto &item = items[idx];
+    const auto width = item.size() + (idx + 1 < items.size() ? 2 : 0);
+    if (column + width > LINE_WIDTH) {
+      buf.append("\n").append(indent + 2, ' ');
+      column = indent + 2;
+    } else {
+      buf.push_back(' ');
+      ++column;
+    }
+    buf.append(item);
+    column += item.size();
+    if (idx + 1 < items.size()) {
+      buf.push_back(',');
+      ++column;
+    }
+  }
+  buf.append("\n").append(indent, ' ').push_back('}');
+}
+
+template <typename F>
+[[nodiscard]] std::vector<std::string> numbers(const usize count, F &&f) {
+  std::vector<std::string> ret{};
+  ret.reserve(count);
+  for (usize idx = 0; idx < count; ++idx)
+    ret.push_back(std::to_string(f(idx)));
+  return ret;
+}
+
+// Appends `type name[state_count][cols_name] = {...};` with one braced row
+// per state.
+template <typename F>
+void append_table(
+    std::string &buf, const std::string_view type, const std::string_view name,
+    const usize rows, const std::string_view cols_name, const usize cols, F &&f
+) {
+  buf.append(std::format(
+      "inline constexpr {} {}[state_count][{}] = {{", type, name, cols_name
+  ));
+  for (usize row = 0; row < rows; ++row) {
+    buf.append("\n    ");
+    append_list(
+        buf,
+        numbers(
+            cols,
+            [&](const usize col) {
+              return f(row, col);
+            }
+        ),
+        4
+    );
+    buf.push_back(',');
+  }
+  buf.append("\n};\n\n");
+}
+
+} // namespace
+
+std::string emit_header(
+    const Grammar &grammar, const TableView &table,
+    const std::string_view name_space
+) {
+  const auto &symbols = grammar.symbols;
+  const auto &production_list = grammar.production_list;
+  const auto terminal_count = table.terminal_count;
+  const auto nonterminal_count = table.cols - terminal_count;
+
+  u64 max_cell = 0;
+  for (usize row = 0; row < table.rows; ++row)
+    for (u32 col = 0; col < terminal_count; ++col)
+      max_cell = std::max<u64>(max_cell, table.lookup(row, col).bits);
+  usize max_length = 0;
+  for (const auto &rhs : production_list | std::views::values)
+    max_length = std::max(max_length, rhs.size());
+
+  std::string buf = "// Generated by ExParserR. Do not edit.\n//\n";
+  for (usize rule = 0; rule < production_list.size(); ++rule)
+    buf.append(std::format(
+        "//   ({}) {}\n", rule, to_string(production_list[rule], symbols)
+    ));
+  buf.append(R"(
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+)");
+  buf.append(std::format("namespace {} {{\n\n", name_space));
+
+  buf.append(std::format(
+      "using state_t = {};\n"
+      "using rule_t = {};\n"
+      "using cell_t = {};\n\n",
+      uint_type(table.rows), uint_type(production_list.size()),
+      uint_type(max_cell)
+  ));
+  buf.append(std::format(
+      "inline constexpr std::uint32_t terminal_count = {};\n"
+      "inline constexpr std::uint32_t nonterminal_count = {};\n"
+      "inline constexpr std::uint32_t state_count = {};\n"
+      "inline constexpr std::uint32_t rule_count = {};\n"
+      "// Terminal id the input must end with.\n"
+      "inline constexpr std::uint32_t end_symbol = {};\n\n",
+      terminal_count, nonterminal_count, table.rows, production_list.size(),
+      Grammar::END_SYMBOL.id
+  ));
+
+  buf.append("// By symbol id: terminals, then non-terminals.\n"
+             "inline constexpr const char *symbol_names[] = ");
+  std::vector<std::string> names{};
+  for (u32 id = 0; id < symbols.size(); ++id)
+    names.push_back(quoted(symbols.name(symbols.at(id))));
+  append_list(buf, names, 0);
+  buf.append(";\n");
+
+  buf.append(R"(
+// A cell holds its kind in the low 3 bits and the target state or rule
+// above them.
+enum action_kind : unsigned { error, shift, go_to, reduce, accept };
+
+)");
+  append_table(
+      buf, "cell_t", "action", table.rows, "terminal_count", terminal_count,
+      [&](const usize row, const usize col) {
+        return table.lookup(row, static_cast<u32>(col)).bits;
+      }
+  );
+
+  buf.append("// A reduce cell for states that reduce by one rule on every "
+             "lookahead they\n// accept, and so need not read it; 0 for the "
+             "rest.\n");
+  buf.append("inline constexpr cell_t default_reduction[state_count] = ");
+  append_list(
+      buf,
+      numbers(
+          table.rows,
+          [&](const usize row) {
+            return table.default_reduction(row).bits;
+          }
+      ),
+      0
+  );
+  buf.append(";\n\n");
+
+  buf.append("// Columns are non-terminal ids minus terminal_count. Entries "
+             "that no parse\n// reaches are 0.\n");
+  append_table(
+      buf, "state_t", "go_to_table", table.rows, "nonterminal_count",
+      nonterminal_count,
+      [&](const usize row, const usize col) {
+        return table.lookup(row, static_cast<u32>(terminal_count + col))
+            .value();
+      }
+  );
+
+  buf.append(std::format(
+      "inline constexpr {} rule_length[rule_count] = ", uint_type(max_length)
+  ));
+  append_list(
+      buf,
+      numbers(
+          production_list.size(),
+          [&](const usize rule) {
+            return production_list[rule].second.size();
+          }
+      ),
+      0
+  );
+  buf.append(";\n\n// Non-terminal ids minus terminal_count.\n");
+  buf.append(std::format(
+      "inline constexpr {} rule_lhs[rule_count] = ",
+      uint_type(nonterminal_count)
+  ));
+  append_list(
+      buf,
+      numbers(
+          production_list.size(),
+          [&](const usize rule) {
+            return production_list[rule].first.id - terminal_count;
+          }
+      ),
+      0
+  );
+  buf.append(";\n");
+
+  buf.append(R"(
+// Parses the terminal ids returned by successive calls to `next`, which
+// must return end_symbol once the input runs out, and calls
+// `on_reduce(rule)` after each reduction. A terminal is only asked for when
+// a state needs it, so default reductions run before it arrives. Returns
+// whether the input was accepted. Usable in constant expressions.
+template <typename Next, typename OnReduce>
+constexpr bool parse(Next &&next, OnReduce &&on_reduce) {
+  std::vector<state_t> stack{0};
+  std::uint32_t lookahead = 0;
+  bool has_lookahead = false;
+  while (true) {
+    cell_t cell = default_reduction[stack.back()];
+    if (cell == 0) {
+      if (!has_lookahead) {
+        lookahead = next();
+        has_lookahead = true;
+      }
+      if (lookahead >= terminal_count)
+        return false;
+      cell = action[stack.back()][lookahead];
+    }
+    const auto value = static_cast<std::uint32_t>(cell >> 3);
+    switch (cell & 7u) {
+    case shift:
+      stack.push_back(static_cast<state_t>(value));
+      has_lookahead = false;
+      break;
+    case reduce:
+      stack.resize(stack.size() - rule_length[value]);
+      stack.push_back(go_to_table[stack.back()][rule_lhs[value]]);
+      on_reduce(static_cast<rule_t>(value));
+      break;
+    case accept:
+      return true;
+    default:
+      return false;
+    }
+  }
+}
+
+template <typename Next>
+constexpr bool parse(Next &&next) {
+  return parse(std::forward<Next>(next), [](rule_t) {});
+}
+
+)");
+  buf.append(std::format("}} // namespace {}\n", name_space));
+  return buf;
+}
+
+} // namespace epr
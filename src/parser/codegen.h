@@ -0,0 +1,28 @@
+#pragma once
+
+#ifndef EPR_PARSER_CODEGEN_H
+#  define EPR_PARSER_CODEGEN_H
+
+#  include "parser/grammar.h"
+#  include "parser/parsing_table.h"
+#  include "util/all.h"
+
+#  include <string>
+#  include <string_view>
+
+namespace epr {
+
+// Source of a self-contained C++20 header holding `table` as constexpr
+// arrays in namespace `name_space`: actions by state and terminal, default
+// reductions by state, gotos by state and non-terminal, production lengths
+// and left-hand sides, symbol names, and a templated driver. The header
+// depends on the standard library only, and each array uses the narrowest
+// unsigned type that fits it.
+[[nodiscard]] std::string emit_header(
+    const Grammar &grammar, const TableView &table,
+    std::string_view name_space = "epr_generated"
+);
+
+} // namespace epr
+
+#endif // !EPR_PARSER_CODEGEN_H
@@ -5,49 +5,137 @@
 #include <algorithm>
 #include <cassert>
 #include <format>
+#include <optional>
 #include <string>
 
 namespace epr {
 
-Dfa::Dfa(Grammar &grammar) {
-  State start_state;
-  const auto &start_production_set =
-      grammar.productions.at(grammar.start_symbol);
-  assert(start_production_set.size() == 1); // ensures that the grammar is
-                                            // augmented
-  const auto &start_production = *start_production_set.begin();
-  start_state.push(
-      {grammar.start_symbol, start_production, 0, Grammar::END_SYMBOL}
+std::string to_string(const Construction construction) {
+  switch (construction) {
+    case Construction::Lr1:
+      return "LR(1)";
+    case Construction::Lalr1:
+      return "LALR(1)";
+    case Construction::MinimalLr1:
+      return "Minimal LR(1)";
+    default:
+      std::unreachable();
+  }
+}
+
+std::string MergeStats::to_string() const {
+  return std::format(
+      "{} LR(0) cores, {} goto targets merged, {} states kept split", cores,
+      merged, split
   );
-  start_state.self_closure(grammar);
-  states.push_back(start_state);
+}
+
+Dfa::Dfa(const Grammar &grammar, const usize threads) {
+  build_states(grammar, Grammar::END_SYMBOL, &ItemSet::self_closure, threads);
+}
+
+Dfa Dfa::build(
+    const Grammar &grammar, const Construction construction,
+    const usize threads
+) {
+  switch (construction) {
+    case Construction::Lr1:
+      return Dfa(grammar, threads);
+    case Construction::Lalr1:
+      return lalr1(grammar, threads);
+    case Construction::MinimalLr1:
+      return minimal_lr1(grammar);
+    default:
+      std::unreachable();
+  }
+}
+
+void Dfa::build_states(
+    const Grammar &grammar, const Symbol &lookahead, const Closure closure,
+    const usize threads
+) {
+  State start_state;
+  const auto &start_rules = grammar.productions_of.at(grammar.start_symbol.id);
+  assert(start_rules.size() == 1); // ensures that the grammar is augmented
+  start_state.push({start_rules.front(), 0, lookahead});
+  (start_state.*closure)(grammar);
+
+  // States are identified by their kernels, so a goto target is only closed
+  // when its kernel has not been seen before.
+  HashIndex index;
+  index.insert(start_state.kernel_hash(), 0);
+  states.push_back(std::move(start_state));
   transitions.resize(1);
 
-  for (usize idx = 0; idx < states.size(); ++idx)
-    for (const auto &symbol : states.at(idx).next_symbols()) {
-      const auto &&next_state = states.at(idx).go(grammar, symbol);
-      if (next_state.items.empty())
-        continue;
-      auto it = std::ranges::find(states, next_state);
-      if (it == states.end()) {
-        states.push_back(next_state);
+  struct Successor {
+    Symbol symbol;
+    std::optional<u32> target; // unset while the kernel is new
+    u64 hash{};
+    State kernel{};
+  };
+
+  auto find = [&](const u64 hash, const State &kernel) {
+    return index.find(hash, [&](const u32 state_idx) {
+      return std::ranges::equal(states[state_idx].kernel(), kernel.kernel());
+    });
+  };
+
+  // Breadth-first by levels. Successor kernels of a level are computed and
+  // looked up in parallel against the index, which is read-only meanwhile.
+  // New kernels are then numbered serially in (state, symbol) order, which
+  // gives the same numbering as a sequential worklist, and finally closed in
+  // parallel.
+  ThreadPool pool(threads);
+  std::vector<std::vector<Successor>> successors{};
+  for (usize level_begin = 0; level_begin < states.size();) {
+    const usize level_end = states.size();
+
+    successors.assign(level_end - level_begin, {});
+    pool.parallel_for(successors.size(), [&](const usize offset, usize) {
+      const auto &state = states[level_begin + offset];
+      for (const auto &symbol : state.next_symbols(grammar)) {
+        auto next_kernel = state.go_kernel(grammar, symbol);
+        if (next_kernel.items.empty())
+          continue;
+        const auto hash = next_kernel.kernel_hash();
+        const auto target = find(hash, next_kernel);
+        successors[offset].push_back(
+            {symbol, target, hash, target ? State{} : std::move(next_kernel)}
+        );
+      }
+    });
+
+    for (usize offset = 0; offset < successors.size(); ++offset)
+      for (auto &[symbol, target, hash, kernel] : successors[offset]) {
+        if (!target && !(target = find(hash, kernel))) {
+          target = static_cast<u32>(states.size());
+          index.insert(hash, *target);
+          states.push_back(std::move(kernel));
+        }
         transitions.resize(states.size());
-        it = std::prev(states.end());
+        transitions.at(level_begin + offset).insert({symbol, *target});
       }
-      transitions.at(idx).insert({symbol, std::distance(states.begin(), it)});
-    }
+
+    pool.parallel_for(
+        states.size() - level_end,
+        [&](const usize offset, usize) {
+          (states[level_end + offset].*closure)(grammar);
+        }
+    );
+    level_begin = level_end;
+  }
 }
 
-std::string Dfa::sets_to_string() const {
+std::string Dfa::sets_to_string(const Grammar &grammar) const {
   std::string buf;
   for (usize idx = 0; idx < states.size(); ++idx)
     buf.append(std::format(
-        "\033[33mI{}:\033[0m\n{}\n\n", idx, states.at(idx).to_string()
+        "\033[33mI{}:\033[0m\n{}\n\n", idx, states.at(idx).to_string(grammar)
     ));
   return buf;
 }
 
-std::string Dfa::transitions_to_string() const {
+std::string Dfa::transitions_to_string(const SymbolTable &symbols) const {
   std::string buf;
   for (usize idx = 0; idx < states.size(); ++idx) {
     if (transitions.at(idx).empty())
@@ -58,9 +146,9 @@ std::string Dfa::transitions_to_string() const {
         buf.append(std::format("I{}", idx));
       else
         buf.append(std::format("{}", std::string(1 + len(idx), ' ')));
-      buf.append(
-          std::format(" --- {} --> I{}\n", symbol.to_string(), next_state_idx)
-      );
+      buf.append(std::format(
+          " --- {} --> I{}\n", symbol.to_string(symbols), next_state_idx
+      ));
       // buf.append(std::format(
       //     "I{} -> I{} [label = \"{}\"]\n", idx, next_state_idx,
       //     symbol.to_string()
@@ -10,17 +10,61 @@
 
 namespace epr {
 
+enum class Construction : u8 {
+  Lr1, // canonical
+  Lalr1,
+  MinimalLr1,
+};
+
+[[nodiscard]] std::string to_string(Construction construction);
+
+// Outcome of state merging in minimal LR(1) construction.
+struct MergeStats {
+  usize cores{};  // distinct LR(0) cores among the final states
+  usize merged{}; // goto targets folded into a differing state that is kept
+  usize split{};  // states kept apart from another state of the same core
+
+  [[nodiscard]] std::string to_string() const;
+};
+
 struct Dfa {
   using State = ItemSet;
 
   std::vector<State> states{};
   std::vector<std::map<Symbol, usize>> transitions{};
+  MergeStats merge_stats{};
+
+  // Canonical LR(1) automaton, built with `threads` workers.
+  explicit Dfa(const Grammar &grammar, usize threads = 1);
+
+  // LR(0) automaton whose complete items carry LALR(1) lookaheads, computed
+  // with DeRemer and Pennello's relations. Other items have the empty symbol
+  // as lookahead.
+  static Dfa lalr1(const Grammar &grammar, usize threads = 1);
+
+  // LR(1) automaton in which a goto target joins an existing state of the
+  // same LR(0) core whenever the two are weakly compatible in Pager's sense,
+  // so merging cannot introduce a reduce/reduce conflict.
+  static Dfa minimal_lr1(const Grammar &grammar);
+
+  // Minimal LR(1) construction is always sequential.
+  static Dfa
+  build(const Grammar &grammar, Construction construction, usize threads = 1);
+
+  [[nodiscard]] std::string sets_to_string(const Grammar &grammar) const;
+
+  [[nodiscard]] std::string
+  transitions_to_string(const SymbolTable &symbols) const;
 
-  explicit Dfa(Grammar &grammar);
+private:
+  using Closure = void (ItemSet::*)(const Grammar &);
 
-  [[nodiscard]] std::string sets_to_string() const;
+  Dfa() = default;
 
-  [[nodiscard]] std::string transitions_to_string() const;
+  void build_states(
+      const Grammar &grammar, const Symbol &lookahead, Closure closure,
+      usize threads
+  );
 };
 
 } // namespace epr
@@ -8,19 +8,17 @@
 
 namespace epr {
 
-std::string to_string(const FirstSet &set, const std::string &name) {
-  std::string buf;
-  for (const auto &[symbol, symbol_set] : set) {
-    buf.append(name).append("( ").append(symbol.to_string()).append(" ) = { ");
-    if (!symbol_set.empty())
-      for (const auto &symbol_ : symbol_set)
-        buf.append(symbol_.to_string()).append(", ");
-    if (!symbol_set.empty())
-      buf.pop_back(), buf.pop_back();
-    buf.append(" }\n");
+std::string to_string(const Associativity associativity) {
+  switch (associativity) {
+    case Associativity::Left:
+      return "%left";
+    case Associativity::Right:
+      return "%right";
+    case Associativity::NonAssoc:
+      return "%nonassoc";
+    default:
+      return "%none";
   }
-  buf.pop_back();
-  return buf;
 }
 
 Grammar::Grammar(Symbol start_symbol_):
@@ -31,28 +29,91 @@ Grammar Grammar::from_str(const std::string &str) {
   if (lines.empty())
     throw std::runtime_error("Empty grammar string");
 
-  Grammar grammar(Symbol(lines.front(), Symbol::NonTerminator));
+  // Names are collected before interning so that terminals and
+  // non-terminals each get a contiguous id range.
+  struct RawRhs {
+    std::vector<std::string> names{};
+    std::string precedence_tag{};
+  };
+  std::vector<std::pair<std::string, std::vector<RawRhs>>> raw_productions{};
+  std::set<std::string> terminal_names{};
+  std::set<std::string> nonterminal_names{lines.front()};
+  std::map<std::string, Precedence> precedence{};
+  u32 level = 0;
+
+  for (auto &&line : std::views::drop(lines, 1)) {
+    if (line.starts_with('%')) {
+      const auto words = split(line, ' ');
+      const auto associativity = declared_associativity(words[0]);
+      if (associativity == Associativity::None)
+        throw std::runtime_error(
+            std::format("Unknown declaration '{}'", words[0])
+        );
+      ++level;
+      for (auto &&name : std::views::drop(words, 1))
+        precedence[name] = {level, associativity};
+      continue;
+    }
 
-  lines.erase(lines.begin());
-  for (auto &&line : lines) {
     auto vec = split(line, " -> ");
-    auto lhs = Symbol(vec[0], Symbol::NonTerminator);
-    auto rhs_vec = std::vector<std::string>(split(vec[1], " | "));
-    auto rhs_set = std::set<std::vector<Symbol>>{};
-    for (auto &&rhs : rhs_vec) {
-      auto rhs_symbol_vec = std::vector<Symbol>{};
-      for (auto &&symbol : split(rhs, ' ')) {
-        if (symbol == "ε")
-          rhs_symbol_vec.emplace_back(Symbol::empty_symbol());
-        else if (isupper(symbol[0]))
-          rhs_symbol_vec.emplace_back(symbol, Symbol::NonTerminator);
+    nonterminal_names.emplace(vec[0]);
+    auto &[lhs, rhs_vec] =
+        raw_productions.emplace_back(vec[0], std::vector<RawRhs>{});
+    for (auto &&rhs : split(vec[1], " | ")) {
+      auto &raw_rhs = rhs_vec.emplace_back();
+      const auto words = split(rhs, ' ');
+      for (usize idx = 0; idx < words.size(); ++idx) {
+        const auto &name = words[idx];
+        if (name == "ε")
+          continue;
+        if (name == "%prec") {
+          if (idx + 2 != words.size())
+            throw std::runtime_error(
+                std::format("'%prec' must end with one name in '{}'", rhs)
+            );
+          raw_rhs.precedence_tag = words[++idx];
+          if (!precedence.contains(raw_rhs.precedence_tag))
+            throw std::runtime_error(std::format(
+                "Undeclared precedence '{}'", raw_rhs.precedence_tag
+            ));
+          continue;
+        }
+        raw_rhs.names.push_back(name);
+        if (is_nonterminal_name(name))
+          nonterminal_names.emplace(name);
         else
-          rhs_symbol_vec.emplace_back(symbol, Symbol::Terminator);
+          terminal_names.emplace(name);
       }
+    }
+  }
+
+  SymbolTable symbols{};
+  for (const auto &name : terminal_names)
+    symbols.intern(name, Symbol::Terminator);
+  for (const auto &name : nonterminal_names)
+    symbols.intern(name, Symbol::NonTerminator);
+
+  Grammar grammar(*symbols.find(lines.front()));
+  for (auto &&[lhs, rhs_vec] : raw_productions) {
+    auto rhs_set = std::set<std::vector<Symbol>>{};
+    for (auto &&[names, precedence_tag] : rhs_vec) {
+      auto rhs_symbol_vec = std::vector<Symbol>{};
+      for (auto &&name : names)
+        rhs_symbol_vec.push_back(*symbols.find(name));
+      // A repeated production keeps its first place.
+      grammar.declaration_index.try_emplace(
+          {*symbols.find(lhs), rhs_symbol_vec},
+          grammar.declaration_index.size()
+      );
+      if (!precedence_tag.empty())
+        grammar.precedence_tags[{*symbols.find(lhs), rhs_symbol_vec}] =
+            precedence_tag;
       rhs_set.emplace(std::move(rhs_symbol_vec));
     }
-    grammar.push_productions(lhs, std::move(rhs_set));
+    grammar.push_productions(*symbols.find(lhs), std::move(rhs_set));
   }
+  grammar.symbols = std::move(symbols);
+  grammar.precedence = std::move(precedence);
   return grammar;
 }
 
@@ -66,45 +127,112 @@ std::string Grammar::to_string() const {
 
   std::string buf;
 
-  buf.append(std::format("StartSymbol: {}\n", start_symbol.to_string()));
+  buf.append(
+      std::format("StartSymbol: {}\n", start_symbol.to_string(symbols))
+  );
 
   buf.append("Terminators: {");
   for (const auto &terminator : terminators)
-    buf.append(std::format("{}, ", terminator.to_string()));
+    buf.append(std::format("{}, ", terminator.to_string(symbols)));
   if (!terminators.empty())
     buf.pop_back(), buf.pop_back();
   buf.append("}\n");
 
   buf.append("NonTerminators: {");
   for (const auto &nonterminator : nonterminators)
-    buf.append(std::format("{}, ", nonterminator.to_string()));
+    buf.append(std::format("{}, ", nonterminator.to_string(symbols)));
   if (!nonterminators.empty())
     buf.pop_back(), buf.pop_back();
   buf.append("}\n");
 
+  if (!precedence.empty()) {
+    std::map<u32, std::string> levels{};
+    for (const auto &[name, declared] : precedence) {
+      auto &level = levels[declared.level];
+      if (level.empty())
+        level = epr::to_string(declared.associativity);
+      level.append(1, ' ').append(name);
+    }
+    buf.append("Precedence: {");
+    for (const auto &level : levels | std::views::values)
+      buf.append(level).append(", ");
+    buf.pop_back(), buf.pop_back();
+    buf.append("}\n");
+  }
+
   buf.append("Productions: {\n");
 
   for (const auto &[lhs, rhs_set] : productions)
-    for (const auto &rhs : rhs_set)
+    for (const auto &rhs : rhs_set) {
       buf.append(std::format(
-          "  ({}) {}\n", production_index.at({lhs, rhs}),
-          epr::to_string({lhs, rhs})
+          "  ({}) {}", production_index.at({lhs, rhs}),
+          epr::to_string({lhs, rhs}, symbols)
       ));
+      if (const auto it = precedence_tags.find({lhs, rhs});
+          it != precedence_tags.end())
+        buf.append(" %prec ").append(it->second);
+      buf.push_back('\n');
+    }
   buf.append("}");
   return buf;
 }
 
+u64 Grammar::content_hash() const {
+  // Names end in a NUL, alternatives in a '|' and each left-hand side's list
+  // in a ';', so that no two grammars feed the same bytes. Each alternative
+  // brings its declaration index, which settles reduce/reduce conflicts.
+  const auto feed = [](const u64 seed, const std::string &name) {
+    return fnv1a(std::string_view(name.c_str(), name.size() + 1), seed);
+  };
+  auto ret = feed(fnv1a({}), symbols.name(start_symbol));
+  for (const auto &[lhs, rhs_set] : productions) {
+    ret = feed(ret, symbols.name(lhs));
+    for (const auto &rhs : rhs_set) {
+      for (const auto &symbol : rhs)
+        ret = feed(ret, symbols.name(symbol));
+      if (const auto it = declaration_index.find({lhs, rhs});
+          it != declaration_index.end())
+        ret = feed(ret, std::to_string(it->second));
+      ret = fnv1a("|", ret);
+    }
+    ret = fnv1a(";", ret);
+  }
+  // Precedence declarations and %prec tags follow a '%'.
+  ret = fnv1a("%", ret);
+  for (const auto &[name, declared] : precedence) {
+    ret = feed(ret, name);
+    ret = feed(
+        ret, std::format(
+                 "{}:{}", declared.level,
+                 static_cast<u32>(declared.associativity)
+             )
+    );
+  }
+  for (const auto &[production, tag] : precedence_tags) {
+    ret = feed(ret, symbols.name(production.first));
+    for (const auto &symbol : production.second)
+      ret = feed(ret, symbols.name(symbol));
+    ret = feed(ret, tag);
+  }
+  return ret;
+}
+
+Precedence Grammar::precedence_of(const Symbol &terminal) const {
+  const auto it = precedence.find(symbols.name(terminal));
+  return it == precedence.end() ? Precedence{} : it->second;
+}
+
 std::pair<std::set<Symbol>, bool> Grammar::get_terminators() const {
   std::set<Symbol> terminators{};
   bool has_empty_symbol = false;
   for (const auto &rhs_set : productions | std::views::values)
-    for (const auto &rhs : rhs_set)
-      for (const auto &symbol : rhs) {
-        if (symbol.name.empty())
-          has_empty_symbol = true;
-        else if (symbol.type == Symbol::Terminator)
+    for (const auto &rhs : rhs_set) {
+      if (rhs.empty())
+        has_empty_symbol = true;
+      for (const auto &symbol : rhs)
+        if (symbol.type == Symbol::Terminator)
           terminators.emplace(symbol);
-      }
+    }
   return {terminators, has_empty_symbol};
 }
 
@@ -121,10 +249,11 @@ std::set<Symbol> Grammar::get_nonterminators() const {
 }
 
 void Grammar::self_augment() {
-  auto new_start_symbol =
-      Symbol(start_symbol.name + '\'', Symbol::NonTerminator);
-  while (productions.contains(new_start_symbol))
-    new_start_symbol.name.push_back('\'');
+  auto new_start_name = symbols.name(start_symbol) + '\'';
+  while (symbols.find(new_start_name))
+    new_start_name.push_back('\'');
+  const auto new_start_symbol =
+      symbols.intern(new_start_name, Symbol::NonTerminator);
   push_production(new_start_symbol, {start_symbol});
   start_symbol = new_start_symbol;
 }
@@ -151,58 +280,44 @@ void Grammar::push_production(const Symbol &lhs, std::vector<Symbol> &&rhs) {
   productions[lhs].emplace(std::move(rhs));
 }
 
-void Grammar::build_first_set() {
-  const auto [terminators, terminators_has_empty] = get_terminators();
-
-  for (const auto &terminator : terminators)
-    first_set[terminator].emplace(terminator);
-  if (terminators_has_empty)
-    first_set[Symbol::empty_symbol()].emplace(Symbol::empty_symbol());
-
-  for (bool changed;;) {
-    changed = false;
-
-    for (const auto &[lhs, rhs_set] : productions) {
-      for (const auto &rhs : rhs_set) {
-        if (rhs.empty()) {
-          changed |= first_set[lhs].emplace(Symbol::empty_symbol()).second;
-          continue;
-        }
-
-        const auto old_size = first_set[lhs].size();
-        for (const auto &symbol : rhs) {
-          auto &first_set_rhs = first_set[symbol];
-          first_set[lhs].insert(first_set_rhs.begin(), first_set_rhs.end());
-          if (!first_set_rhs.contains(Symbol::empty_symbol()))
-            break;
-        }
-        changed |= first_set[lhs].size() != old_size;
-      }
-    }
-
-    if (!changed)
-      break;
-  }
-  first_set[epr::Grammar::END_SYMBOL].emplace(epr::Grammar::END_SYMBOL);
-}
-
 void Grammar::build_production_index() {
+  // Items pack a terminal id and a dot position into 16 bits each.
+  if (symbols.terminal_count() > 0x10000)
+    throw std::runtime_error("Too many terminals in grammar");
+
+  productions_of.assign(symbols.size(), {});
   for (const auto &[lhs, rhs_set] : productions)
     for (const auto &rhs : rhs_set) {
+      if (rhs.size() >= 0x10000)
+        throw std::runtime_error("Production too long");
       production_list.emplace_back(lhs, rhs);
-      production_index[{lhs, rhs}] = production_list.size() - 1;
+      const auto rule = production_list.size() - 1;
+      production_index[{lhs, rhs}] = rule;
+      productions_of[lhs.id].push_back(rule);
+      const auto declared = declaration_index.find({lhs, rhs});
+      rule_declaration.push_back(
+          declared != declaration_index.end()
+              ? declared->second
+              : declaration_index.size() + rule
+      );
+
+      // As in yacc: an explicit %prec, else that of the last terminal.
+      auto &rule_prec = rule_precedence.emplace_back();
+      if (const auto it = precedence_tags.find({lhs, rhs});
+          it != precedence_tags.end())
+        rule_prec = precedence.at(it->second);
+      else if (const auto last = std::ranges::find(
+                   rhs | std::views::reverse, Symbol::Terminator, &Symbol::type
+               );
+               last != std::ranges::rend(rhs))
+        rule_prec = precedence_of(*last);
     }
 }
 
-std::set<Symbol> Grammar::first(const std::vector<Symbol> &str) const {
-  std::set<Symbol> ret{};
-  for (const auto &symbol : str) {
-    const auto &first_set_rhs = first_set.at(symbol);
-    ret.insert(first_set_rhs.begin(), first_set_rhs.end());
-    if (!first_set_rhs.contains(Symbol::empty_symbol()))
-      break;
-  }
-  return ret;
+void Grammar::build_analysis() {
+  analysis = GrammarAnalysis(production_list, symbols, start_symbol);
+  closure_table =
+      ClosureTable(production_list, productions_of, analysis, symbols);
 }
 
 } // namespace epr
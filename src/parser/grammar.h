@@ -3,30 +3,76 @@
 #ifndef EPR_PARSER_GRAMMAR_H
 #  define EPR_PARSER_GRAMMAR_H
 
+#  include "parser/analysis.h"
+#  include "parser/closure.h"
 #  include "parser/symbol.h"
 #  include "util/all.h"
 
 #  include <map>
 #  include <set>
 #  include <string>
+#  include <string_view>
 #  include <utility>
 #  include <vector>
 
 namespace epr {
 
-using FirstSet = std::map<Symbol, std::set<Symbol>>;
-
-[[nodiscard]] std::string
-to_string(const FirstSet &set, const std::string &name);
+enum class Associativity : u8 { None, Left, Right, NonAssoc };
+
+[[nodiscard]] std::string to_string(Associativity associativity);
+
+// Names that start with an upper-case letter are non-terminals.
+[[nodiscard]] constexpr bool is_nonterminal_name(const std::string_view name) {
+  return !name.empty() && name[0] >= 'A' && name[0] <= 'Z';
+}
+
+// What a %left, %right or %nonassoc line declares; None for any other word.
+[[nodiscard]] constexpr Associativity
+declared_associativity(const std::string_view keyword) {
+  if (keyword == "%left")
+    return Associativity::Left;
+  if (keyword == "%right")
+    return Associativity::Right;
+  if (keyword == "%nonassoc")
+    return Associativity::NonAssoc;
+  return Associativity::None;
+}
+
+// Level 0 means undeclared; later declarations bind tighter.
+struct Precedence {
+  u32 level{};
+  Associativity associativity{Associativity::None};
+
+  constexpr auto operator<=>(const Precedence &) const = default;
+};
 
 struct Grammar {
-  inline static Symbol END_SYMBOL{"$", Symbol::Type::Terminator};
+  static constexpr Symbol END_SYMBOL = Symbol::end_symbol();
 
-  FirstSet first_set{};
+  SymbolTable symbols{};
+  GrammarAnalysis analysis{};
+  ClosureTable closure_table{};
   std::map<Symbol, std::set<std::vector<Symbol>>> productions{};
   std::map<std::pair<const Symbol, std::vector<Symbol>>, usize>
       production_index{};
-  std::vector<std::pair<Symbol, std::vector<Symbol>>> production_list{};
+  std::vector<Production> production_list{};
+  std::vector<std::vector<u32>> productions_of{}; // indexed by lhs id
+  // From %left, %right and %nonassoc lines, by name. A name may stand for no
+  // terminal at all and only be used after %prec.
+  std::map<std::string, Precedence> precedence{};
+  // Productions whose precedence is set with %prec instead of coming from
+  // their last terminal.
+  std::map<std::pair<const Symbol, std::vector<Symbol>>, std::string>
+      precedence_tags{};
+  std::vector<Precedence> rule_precedence{}; // indexed by rule
+  // Where each production stands in the grammar text, counting alternatives
+  // one by one. A reduce/reduce conflict goes to the one declared first.
+  std::map<std::pair<const Symbol, std::vector<Symbol>>, usize>
+      declaration_index{};
+  // By rule: its place in declaration_index, or after every declared one,
+  // in rule order, for a production added in code such as the augmented
+  // start.
+  std::vector<usize> rule_declaration{};
   Symbol start_symbol;
 
   explicit Grammar(Symbol start_symbol_);
@@ -43,10 +89,17 @@ struct Grammar {
 
   [[nodiscard]] std::string to_string() const;
 
+  // Hash of the start symbol, the productions by name in the order they were
+  // declared, and the precedences. Spacing and how alternatives are spread
+  // over lines play no part.
+  [[nodiscard]] u64 content_hash() const;
+
   [[nodiscard]] std::pair<std::set<Symbol>, bool> get_terminators() const;
 
   [[nodiscard]] std::set<Symbol> get_nonterminators() const;
 
+  [[nodiscard]] Precedence precedence_of(const Symbol &terminal) const;
+
   void self_augment();
 
   void push_productions(
@@ -60,11 +113,11 @@ struct Grammar {
 
   void push_production(const Symbol &lhs, std::vector<Symbol> &&rhs);
 
-  void build_first_set();
-
+  // Also works out the precedence and declaration order of every rule.
   void build_production_index();
 
-  [[nodiscard]] std::set<Symbol> first(const std::vector<Symbol> &str) const;
+  // Requires the production index. Also builds the closure templates.
+  void build_analysis();
 };
 
 } // namespace epr
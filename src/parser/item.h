@@ -3,45 +3,80 @@
 #ifndef EPR_PARSER_ITEM_H
 #  define EPR_PARSER_ITEM_H
 
+#  include "parser/grammar.h"
 #  include "parser/symbol.h"
 #  include "util/all.h"
 
+#  include <compare>
+#  include <optional>
+#  include <span>
 #  include <string>
-#  include <vector>
 
 namespace epr {
 
+// An LR(1) item packed into one word: the index of its production in
+// Grammar::production_list (bits 32..63), the dot position (bits 16..31) and
+// the lookahead terminal id (bits 0..15). Sorting groups the items of one
+// core together, ordered by lookahead.
 struct Item {
-  Symbol lookahead;
-  std::vector<Symbol> rhs{};
-  Symbol lhs;
-  usize dot_pos{}; // range: [0, rhs.size()]
+  u64 bits{};
 
-  Item(
-      Symbol lhs_, std::vector<Symbol> rhs_, usize dot_pos_, Symbol lookahead_
-  );
+  constexpr Item() = default;
 
-  Item(const Item &rhs) = default;
+  constexpr explicit Item(const u64 bits): bits(bits) {}
 
-  Item(Item &&rhs) noexcept = default;
+  constexpr Item(const u32 rule, const u32 dot_pos, const Symbol &lookahead):
+      bits(u64{rule} << 32 | u64{dot_pos} << 16 | lookahead.id) {}
 
-  Item &operator=(const Item &rhs) = default;
+  constexpr auto operator<=>(const Item &other) const = default;
 
-  Item &operator=(Item &&rhs) noexcept = default;
+  [[nodiscard]] constexpr u32 rule() const {
+    return static_cast<u32>(bits >> 32);
+  }
 
-  bool operator==(const Item &other) const;
+  [[nodiscard]] constexpr u32 dot_pos() const { // range: [0, rhs.size()]
+    return static_cast<u32>(bits >> 16 & 0xFFFF);
+  }
 
-  bool operator<(const Item &other) const;
+  [[nodiscard]] constexpr Symbol lookahead() const {
+    return {static_cast<u32>(bits & 0xFFFF), Symbol::Terminator};
+  }
 
-  [[nodiscard]] Item advance_dot() const;
+  // The item without its lookahead, i.e. its LR(0) item.
+  [[nodiscard]] constexpr u64 core() const {
+    return bits >> 16;
+  }
 
-  [[nodiscard]] bool is_mergeable(const Item &other) const;
+  [[nodiscard]] constexpr Item advance_dot() const {
+    return Item{bits + (u64{1} << 16)};
+  }
 
-  // void merge(const Item &other);
+  [[nodiscard]] constexpr bool is_mergeable(const Item &other) const {
+    return core() == other.core();
+  }
 
-  [[nodiscard]] std::vector<Symbol> back_slice(usize offset = 1) const;
+  [[nodiscard]] const Production &production(const Grammar &grammar) const {
+    return grammar.production_list[rule()];
+  }
 
-  [[nodiscard]] std::string to_string() const;
+  [[nodiscard]] bool is_complete(const Grammar &grammar) const {
+    return dot_pos() == production(grammar).second.size();
+  }
+
+  [[nodiscard]] std::optional<Symbol> next_symbol(const Grammar &grammar
+  ) const {
+    const auto &rhs = production(grammar).second;
+    if (dot_pos() == rhs.size())
+      return std::nullopt;
+    return rhs[dot_pos()];
+  }
+
+  // The symbols following the one after the dot.
+  [[nodiscard]] std::span<const Symbol> rest(const Grammar &grammar) const {
+    return std::span(production(grammar).second).subspan(dot_pos() + 1);
+  }
+
+  [[nodiscard]] std::string to_string(const Grammar &grammar) const;
 };
 
 } // namespace epr
@@ -1,75 +1,182 @@
 #include "parser/item_set.h"
 
+#include <algorithm>
+#include <cstring>
 #include <format>
 #include <string>
 
 namespace epr {
 
+namespace {
+
+// Per-thread buffers for closing item sets, resized whenever the grammar
+// shape changes.
+struct ClosureScratch {
+  usize rule_count{};
+  u32 terminal_count{};
+  std::vector<TerminalSet> lookaheads{}; // indexed by rule
+  std::vector<bool> is_touched{};
+  std::vector<u32> touched{};
+  TerminalSet inherited{};
+
+  static ClosureScratch &get(const Grammar &grammar) {
+    thread_local ClosureScratch scratch;
+    const auto rules = grammar.production_list.size();
+    const auto terminals = grammar.symbols.terminal_count();
+    if (scratch.rule_count != rules || scratch.terminal_count != terminals) {
+      scratch.rule_count = rules;
+      scratch.terminal_count = terminals;
+      scratch.lookaheads.assign(rules, TerminalSet(terminals));
+      scratch.is_touched.assign(rules, false);
+      scratch.inherited = TerminalSet(terminals);
+    }
+    return scratch;
+  }
+
+  TerminalSet &touch(const u32 rule) {
+    if (!is_touched[rule]) {
+      is_touched[rule] = true;
+      touched.push_back(rule);
+    }
+    return lookaheads[rule];
+  }
+
+  // Visits the touched rules in ascending order and resets them.
+  template<typename F>
+  void drain(F &&f) {
+    std::ranges::sort(touched);
+    for (const auto rule : touched) {
+      f(rule, lookaheads[rule]);
+      lookaheads[rule].clear();
+      is_touched[rule] = false;
+    }
+    touched.clear();
+  }
+};
+
+} // namespace
+
 bool ItemSet::operator==(const ItemSet &rhs) const {
-  return items == rhs.items;
+  return items.size() == rhs.items.size() &&
+         (items.empty() ||
+          std::memcmp(
+              items.data(), rhs.items.data(), items.size() * sizeof(Item)
+          ) == 0);
 }
 
 void ItemSet::push(const Item &item) {
-  items.insert(item);
+  items.push_back(item);
+}
+
+void ItemSet::normalize() {
+  std::ranges::sort(items);
+  const auto [first, last] = std::ranges::unique(items);
+  items.erase(first, last);
+}
+
+std::span<const Item> ItemSet::kernel() const {
+  return std::span(items).first(kernel_size);
 }
 
-std::set<Symbol> ItemSet::next_symbols() const {
+u64 ItemSet::kernel_hash() const {
+  static_assert(sizeof(Item) == sizeof(u64));
+  return hash_words(
+      {reinterpret_cast<const u64 *>(items.data()), kernel_size}
+  );
+}
+
+std::set<Symbol> ItemSet::next_symbols(const Grammar &grammar) const {
   std::set<Symbol> buf;
   for (const auto &item : items)
-    if (item.dot_pos < item.rhs.size())
-      buf.insert(item.rhs.at(item.dot_pos));
+    if (const auto symbol = item.next_symbol(grammar))
+      buf.insert(*symbol);
   return buf;
 }
 
 void ItemSet::self_closure(const Grammar &grammar) {
-  while (true) {
-    const usize old_size = items.size();
-
-    for (const auto &item : items) {
-      if (item.dot_pos >= item.rhs.size()) {
-        continue;
-      }
-
-      auto get_production_set = [&](const Symbol &symbol
-                                ) -> std::set<std::vector<Symbol>> {
-        const auto it = grammar.productions.find(symbol);
-        if (it == grammar.productions.end())
-          return std::set<std::vector<Symbol>>{};
-        return it->second;
-      };
-
-      const auto &next_symbol = item.rhs.at(item.dot_pos);
-      const auto &production_set = get_production_set(next_symbol);
-      for (const auto &first = grammar.first(item.back_slice());
-           const Symbol &b : first) {
-        for (const auto &production : production_set)
-          push({next_symbol, production, 0, b});
-      }
+  normalize();
+  kernel_size = items.size();
+
+  auto &scratch = ClosureScratch::get(grammar);
+  auto &inherited = scratch.inherited;
+
+  // Kernel items of one core are adjacent and share the symbol after the dot,
+  // so every core applies the template of that symbol once, with the union of
+  // what its lookaheads pass on. Templates are already transitively closed,
+  // so the added items need no further processing.
+  for (usize begin = 0, end; begin < kernel_size; begin = end) {
+    end = begin + 1;
+    while (end < kernel_size && items[end].is_mergeable(items[begin]))
+      ++end;
+    const auto next_symbol = items[begin].next_symbol(grammar);
+    if (!next_symbol || next_symbol->type != Symbol::NonTerminator)
+      continue;
+
+    inherited.clear();
+    if (grammar.analysis.first(items[begin].rest(grammar), inherited))
+      for (usize idx = begin; idx < end; ++idx)
+        inherited.insert(items[idx].lookahead().id);
+
+    for (const auto &entry : grammar.closure_table[*next_symbol].entries) {
+      auto &lookaheads = scratch.touch(entry.rule);
+      lookaheads.unite(entry.spontaneous);
+      if (entry.propagated)
+        lookaheads.unite(inherited);
     }
-    if (items.size() == old_size) // unchanged
-      break;
   }
+
+  scratch.drain([&](const u32 rule, const TerminalSet &lookaheads) {
+    lookaheads.for_each([&](const u32 id) {
+      push({rule, 0, grammar.symbols.at(id)});
+    });
+  });
 }
 
-ItemSet ItemSet::go(const Grammar &grammar, const Symbol &symbol) const {
+void ItemSet::self_closure_lr0(const Grammar &grammar) {
+  normalize();
+  kernel_size = items.size();
+
+  auto &scratch = ClosureScratch::get(grammar);
+  for (usize idx = 0; idx < kernel_size; ++idx)
+    if (const auto next_symbol = items[idx].next_symbol(grammar);
+        next_symbol && next_symbol->type == Symbol::NonTerminator)
+      for (const auto &entry : grammar.closure_table[*next_symbol].entries)
+        scratch.touch(entry.rule);
+
+  scratch.drain([&](const u32 rule, const TerminalSet &) {
+    push({rule, 0, Symbol::empty_symbol()});
+  });
+}
+
+ItemSet
+ItemSet::go_kernel(const Grammar &grammar, const Symbol &symbol) const {
   ItemSet buf;
   for (const auto &item : items)
-    if (item.dot_pos < item.rhs.size() && item.rhs.at(item.dot_pos) == symbol)
+    if (item.next_symbol(grammar) == symbol)
       buf.push(item.advance_dot());
+  buf.normalize();
+  buf.kernel_size = buf.items.size();
+  return buf;
+}
+
+ItemSet ItemSet::go(const Grammar &grammar, const Symbol &symbol) const {
+  ItemSet buf = go_kernel(grammar, symbol);
   buf.self_closure(grammar);
   return buf;
 }
 
-std::string ItemSet::to_string() const {
+std::string ItemSet::to_string(const Grammar &grammar) const {
   std::string buf;
   auto last_item = items.end();
   for (auto it = items.begin(); it != items.end(); ++it) {
     if (last_item == items.end())
-      buf.append(std::format("{}", it->to_string()));
+      buf.append(std::format("{}", it->to_string(grammar)));
     else if (!it->is_mergeable(*last_item))
-      buf.append(std::format("\n{}", it->to_string()));
+      buf.append(std::format("\n{}", it->to_string(grammar)));
     else
-      buf.append(std::format(" {}", it->lookahead.to_string()));
+      buf.append(
+          std::format(" {}", it->lookahead().to_string(grammar.symbols))
+      );
     last_item = it;
   }
   return buf;
@@ -7,12 +7,17 @@
 #  include "parser/item.h"
 
 #  include <set>
+#  include <span>
 #  include <string>
+#  include <vector>
 
 namespace epr {
 
+// After self_closure(), `items` holds the kernel followed by the items the
+// closure added, each part sorted. A state is determined by its kernel.
 struct ItemSet {
-  std::set<Item> items{};
+  std::vector<Item> items{};
+  usize kernel_size{};
 
   ItemSet() = default;
 
@@ -20,13 +25,26 @@ struct ItemSet {
 
   void push(const Item &item);
 
-  [[nodiscard]] std::set<Symbol> next_symbols() const;
+  void normalize();
+
+  [[nodiscard]] std::span<const Item> kernel() const;
+
+  [[nodiscard]] u64 kernel_hash() const;
+
+  [[nodiscard]] std::set<Symbol> next_symbols(const Grammar &grammar) const;
 
   void self_closure(const Grammar &grammar);
 
+  // Closure over LR(0) items; added items have the empty symbol as lookahead.
+  void self_closure_lr0(const Grammar &grammar);
+
+  // The kernel of the goto target, not yet closed.
+  [[nodiscard]] ItemSet
+  go_kernel(const Grammar &grammar, const Symbol &symbol) const;
+
   [[nodiscard]] ItemSet go(const Grammar &grammar, const Symbol &symbol) const;
 
-  [[nodiscard]] std::string to_string() const;
+  [[nodiscard]] std::string to_string(const Grammar &grammar) const;
 };
 
 } // namespace epr
@@ -0,0 +1,139 @@
+#include "parser/dfa.h"
+
+#include "util/all.h"
+
+#include <algorithm>
+#include <map>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+namespace epr {
+
+namespace {
+
+// DeRemer and Pennello's digraph: takes `sets` to the smallest solution of
+// F(x) = F'(x) ∪ ⋃{F(y) | x R y}. Members of one strongly connected component
+// end up with the same set.
+void digraph(
+    const std::vector<std::vector<u32>> &relation,
+    std::vector<TerminalSet> &sets
+) {
+  for (const auto &component : strongly_connected_components(relation)) {
+    auto &head = sets[component.front()];
+    for (const auto x : component) {
+      if (x != component.front())
+        head.unite(sets[x]);
+      for (const auto y : relation[x])
+        head.unite(sets[y]);
+    }
+    for (const auto x : component)
+      if (x != component.front())
+        sets[x] = head;
+  }
+}
+
+} // namespace
+
+Dfa Dfa::lalr1(const Grammar &grammar, const usize threads) {
+  Dfa dfa;
+  dfa.build_states(
+      grammar, Symbol::empty_symbol(), &ItemSet::self_closure_lr0, threads
+  );
+
+  const auto terminal_count = grammar.symbols.terminal_count();
+  const auto &nullable = grammar.analysis.nullable;
+  const auto start_rule = grammar.productions_of[grammar.start_symbol.id][0];
+
+  // Non-terminal transitions (p, A), numbered densely.
+  std::vector<std::pair<usize, Symbol>> nt_transitions{};
+  std::vector<std::map<Symbol, u32>> nt_index(dfa.states.size());
+  for (usize p = 0; p < dfa.states.size(); ++p)
+    for (const auto &symbol : dfa.transitions[p] | std::views::keys)
+      if (symbol.type == Symbol::NonTerminator) {
+        nt_index[p][symbol] = static_cast<u32>(nt_transitions.size());
+        nt_transitions.emplace_back(p, symbol);
+      }
+
+  // Direct reads and the reads relation. The end marker counts as read after
+  // the start symbol, as if the augmenting production were S' -> S $.
+  std::vector<TerminalSet> follow(
+      nt_transitions.size(), TerminalSet(terminal_count)
+  );
+  std::vector<std::vector<u32>> reads(nt_transitions.size());
+  for (u32 x = 0; x < nt_transitions.size(); ++x) {
+    const auto &[p, nonterminal] = nt_transitions[x];
+    const auto r = dfa.transitions[p].at(nonterminal);
+    for (const auto &symbol : dfa.transitions[r] | std::views::keys)
+      if (symbol.type == Symbol::Terminator)
+        follow[x].insert(symbol.id);
+      else if (nullable[symbol.id])
+        reads[x].push_back(nt_index[r].at(symbol));
+    const auto &items = dfa.states[r].items;
+    if (std::ranges::find(items, Item{start_rule, 1, Symbol::empty_symbol()}) !=
+        items.end())
+      follow[x].insert(Grammar::END_SYMBOL.id);
+  }
+  digraph(reads, follow);
+
+  // includes and lookback, found by walking each production from every
+  // state with a transition on its left-hand side.
+  std::vector<std::vector<u32>> includes(nt_transitions.size());
+  std::map<std::pair<usize, u32>, std::vector<u32>> lookback{};
+  std::vector<bool> nullable_suffix{};
+  for (u32 x = 0; x < nt_transitions.size(); ++x) {
+    const auto &[p, lhs] = nt_transitions[x];
+    for (const auto rule : grammar.productions_of[lhs.id]) {
+      const auto &rhs = grammar.production_list[rule].second;
+      nullable_suffix.assign(rhs.size() + 1, true);
+      for (usize pos = rhs.size(); pos-- > 0;)
+        nullable_suffix[pos] =
+            nullable_suffix[pos + 1] && nullable[rhs[pos].id];
+
+      auto q = p;
+      for (usize pos = 0; pos < rhs.size(); ++pos) {
+        if (rhs[pos].type == Symbol::NonTerminator && nullable_suffix[pos + 1])
+          includes[nt_index[q].at(rhs[pos])].push_back(x);
+        q = dfa.transitions[q].at(rhs[pos]);
+      }
+      lookback[{q, rule}].push_back(x);
+    }
+  }
+  digraph(includes, follow);
+
+  // Expand every complete item into one item per lookahead.
+  TerminalSet lookaheads(terminal_count);
+  for (usize q = 0; q < dfa.states.size(); ++q) {
+    auto &state = dfa.states[q];
+    std::vector<Item> kernel{};
+    std::vector<Item> closure{};
+    for (usize idx = 0; idx < state.items.size(); ++idx) {
+      const auto &item = state.items[idx];
+      auto &part = idx < state.kernel_size ? kernel : closure;
+      if (!item.is_complete(grammar)) {
+        part.push_back(item);
+        continue;
+      }
+      if (item.rule() == start_rule) {
+        part.emplace_back(item.rule(), item.dot_pos(), Grammar::END_SYMBOL);
+        continue;
+      }
+      lookaheads.clear();
+      if (const auto it = lookback.find({q, item.rule()}); it != lookback.end())
+        for (const auto x : it->second)
+          lookaheads.unite(follow[x]);
+      lookaheads.for_each([&](const u32 id) {
+        part.emplace_back(item.rule(), item.dot_pos(), grammar.symbols.at(id));
+      });
+    }
+    std::ranges::sort(kernel);
+    std::ranges::sort(closure);
+    state.kernel_size = kernel.size();
+    state.items = std::move(kernel);
+    state.items.insert(state.items.end(), closure.begin(), closure.end());
+  }
+
+  return dfa;
+}
+
+} // namespace epr
@@ -0,0 +1,177 @@
+#include "parser/dfa.h"
+
+#include "util/all.h"
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <iterator>
+#include <ranges>
+#include <set>
+#include <vector>
+
+namespace epr {
+
+namespace {
+
+std::vector<u64> cores_of(const std::span<const Item> kernel) {
+  std::vector<u64> cores{};
+  for (const auto &item : kernel)
+    if (cores.empty() || cores.back() != item.core())
+      cores.push_back(item.core());
+  return cores;
+}
+
+// Lookaheads of each core item, in core order.
+std::vector<TerminalSet> lookaheads_of(
+    const std::span<const Item> kernel, const usize core_count,
+    const u32 terminal_count
+) {
+  std::vector<TerminalSet> ret(core_count, TerminalSet(terminal_count));
+  usize idx = 0;
+  for (usize pos = 0; pos < kernel.size(); ++pos) {
+    if (pos != 0 && !kernel[pos].is_mergeable(kernel[pos - 1]))
+      ++idx;
+    ret[idx].insert(kernel[pos].lookahead().id);
+  }
+  return ret;
+}
+
+// Pager's weak compatibility: merging may only make two items share a
+// lookahead if they already share one in either of the kernels.
+bool weakly_compatible(
+    const std::span<const Item> lhs, const std::span<const Item> rhs,
+    const usize core_count, const u32 terminal_count
+) {
+  const auto lhs_la = lookaheads_of(lhs, core_count, terminal_count);
+  const auto rhs_la = lookaheads_of(rhs, core_count, terminal_count);
+  for (usize i = 0; i < core_count; ++i)
+    for (usize j = i + 1; j < core_count; ++j) {
+      if (!lhs_la[i].intersects(rhs_la[j]) && !rhs_la[i].intersects(lhs_la[j]))
+        continue;
+      if (!lhs_la[i].intersects(lhs_la[j]) && !rhs_la[i].intersects(rhs_la[j]))
+        return false;
+    }
+  return true;
+}
+
+} // namespace
+
+Dfa Dfa::minimal_lr1(const Grammar &grammar) {
+  const auto terminal_count = grammar.symbols.terminal_count();
+
+  Dfa dfa;
+  std::vector<std::vector<u64>> cores{};
+  std::vector<bool> queued{};
+  // Goto targets folded into each state, counted once the states that
+  // survive are known.
+  std::vector<usize> merges_into{};
+  std::deque<usize> worklist{};
+  HashIndex index; // keyed by core; states of one core share a hash
+
+  auto enqueue = [&](const usize idx) {
+    if (!queued[idx]) {
+      queued[idx] = true;
+      worklist.push_back(idx);
+    }
+  };
+
+  auto add_state = [&](State &&kernel) {
+    const auto idx = dfa.states.size();
+    cores.push_back(cores_of(kernel.kernel()));
+    index.insert(hash_words(cores.back()), static_cast<u32>(idx));
+    dfa.states.push_back(std::move(kernel));
+    dfa.transitions.emplace_back();
+    queued.push_back(false);
+    merges_into.push_back(0);
+    enqueue(idx);
+    return idx;
+  };
+
+  {
+    State start_kernel;
+    const auto &start_rules =
+        grammar.productions_of.at(grammar.start_symbol.id);
+    assert(start_rules.size() == 1); // ensures that the grammar is augmented
+    start_kernel.push({start_rules.front(), 0, Grammar::END_SYMBOL});
+    start_kernel.kernel_size = 1;
+    add_state(std::move(start_kernel));
+  }
+
+  while (!worklist.empty()) {
+    const auto idx = worklist.front();
+    worklist.pop_front();
+    queued[idx] = false;
+
+    // The kernel may have grown since the state was last processed.
+    dfa.states[idx].items.resize(dfa.states[idx].kernel_size);
+    dfa.states[idx].self_closure(grammar);
+    dfa.transitions[idx].clear();
+
+    for (const auto &symbol : dfa.states[idx].next_symbols(grammar)) {
+      auto next_kernel = dfa.states[idx].go_kernel(grammar, symbol);
+      const auto kernel = next_kernel.kernel();
+      const auto next_cores = cores_of(kernel);
+      const auto hash = hash_words(next_cores);
+
+      auto same_core = [&](const u32 state_idx) {
+        return cores[state_idx] == next_cores;
+      };
+      auto target = index.find(hash, [&](const u32 state_idx) {
+        return same_core(state_idx) &&
+               std::ranges::includes(dfa.states[state_idx].kernel(), kernel);
+      });
+      if (target) {
+        if (dfa.states[*target].kernel().size() != kernel.size())
+          ++merges_into[*target];
+      } else if ((target = index.find(hash, [&](const u32 state_idx) {
+                   return same_core(state_idx) &&
+                          weakly_compatible(
+                              dfa.states[state_idx].kernel(), kernel,
+                              next_cores.size(), terminal_count
+                          );
+                 }))) {
+        auto &state = dfa.states[*target];
+        std::vector<Item> merged{};
+        std::ranges::set_union(
+            state.kernel(), kernel, std::back_inserter(merged)
+        );
+        state.items = std::move(merged);
+        state.kernel_size = state.items.size();
+        ++merges_into[*target];
+        enqueue(*target);
+      } else {
+        target = static_cast<u32>(add_state(std::move(next_kernel)));
+      }
+      dfa.transitions[idx][symbol] = *target;
+    }
+  }
+
+  // Growing a kernel can redirect a transition away from its old target, so
+  // keep only the states still reachable, numbered in breadth-first order.
+  std::vector<usize> renumber(dfa.states.size(), dfa.states.size());
+  std::vector<usize> order{0};
+  renumber[0] = 0;
+  for (usize pos = 0; pos < order.size(); ++pos)
+    for (const auto next : dfa.transitions[order[pos]] | std::views::values)
+      if (renumber[next] == dfa.states.size()) {
+        renumber[next] = order.size();
+        order.push_back(next);
+      }
+
+  Dfa ret;
+  std::set<std::vector<u64>> distinct_cores{};
+  for (const auto old_idx : order) {
+    distinct_cores.insert(cores[old_idx]);
+    ret.merge_stats.merged += merges_into[old_idx];
+    ret.states.push_back(std::move(dfa.states[old_idx]));
+    auto &transitions = ret.transitions.emplace_back();
+    for (const auto &[symbol, next] : dfa.transitions[old_idx])
+      transitions.emplace(symbol, renumber[next]);
+  }
+  ret.merge_stats.cores = distinct_cores.size();
+  ret.merge_stats.split = ret.states.size() - distinct_cores.size();
+  return ret;
+}
+
+} // namespace epr
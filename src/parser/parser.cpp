@@ -2,6 +2,7 @@
 
 #include "parser/dfa.h"
 
+#include <array>
 #include <format>
 #include <iostream>
 #include <utility>
@@ -10,107 +11,20 @@ namespace epr {
 
 using namespace std::string_literals;
 
-std::string to_string(const Action &action) {
-  return std::visit(
-      overloaded{
-          [](const Error &) {
-            return ""s;
-          },
-          [](const Shift &shift) {
-            return std::format("s{}", shift.state);
-          },
-          [](const Goto &go_to) {
-            return std::format("{}", go_to.state);
-          },
-          [](const Reduce &reduce) {
-            return std::format("r{}", reduce.rule);
-          },
-          [](const Accept &) {
-            return "acc"s;
-          },
-      },
-      action
-  );
-}
-
-ParsingTable::ParsingTable(const Dfa &dfa, const Grammar &grammar) {
-  usize col_idx = 0;
-  for (const auto &symbol : grammar.get_terminators().first)
-    terminals.insert({symbol, ++col_idx});
-  terminals.insert({Grammar::END_SYMBOL, ++col_idx});
-  for (const auto &symbol : grammar.get_nonterminators())
-    non_terminals.insert({symbol, ++col_idx});
-
-  usize row_idx = 0;
-  table.resize(dfa.states.size());
-  for (const auto &state : dfa.states) {
-    table[row_idx].resize(col_idx + 1);
-
-    // accept and reduce
-    for (const auto &item : state.items)
-      if (item.dot_pos == item.rhs.size()) {
-        if (item.lhs == grammar.start_symbol)
-          table[row_idx][terminals.at(Grammar::END_SYMBOL)] = Action{Accept{}};
-        else
-          table[row_idx][terminals.at(item.lookahead)] =
-              Action{Reduce{grammar.production_index.at({item.lhs, item.rhs})}};
-      }
-
-    // shift and goto
-    for (const auto &[symbol, next_state_idx] : dfa.transitions.at(row_idx))
-      if (symbol.type == Symbol::Type::Terminator)
-        table[row_idx][terminals.at(symbol)] = Action{Shift{next_state_idx}};
-      else
-        table[row_idx][non_terminals.at(symbol)] = Action{Goto{next_state_idx}};
-
-    ++row_idx;
-  }
-}
-
-Action ParsingTable::get_action(const usize state, const Symbol &symbol) const {
-  switch (symbol.type) {
-    case Symbol::Type::Terminator:
-      return table.at(state).at(terminals.at(symbol));
-    case Symbol::Type::NonTerminator:
-      return table.at(state).at(non_terminals.at(symbol));
-    default:
-      std::unreachable();
-  }
-}
-
-Table ParsingTable::to_table() const {
-  Table ret;
-  ret.resize(table.size() + 1);
-
-  { // header
-    ret[0].resize(terminals.size() + non_terminals.size() + 1);
-    for (const auto &[symbol, idx] : terminals)
-      ret[0][idx] = symbol.to_string();
-    for (const auto &[symbol, idx] : non_terminals)
-      ret[0][idx] = symbol.to_string();
-  }
+namespace {
 
-  // body
-  for (usize i = 0; i < table.size(); ++i) {
-    ret[i + 1].resize(table.at(i).size());
-    ret[i + 1][0] = std::format("I{}", i);
-    for (usize j = 1; j < table.at(i).size(); ++j)
-      ret[i + 1][j] = epr::to_string(table.at(i).at(j));
-  }
-
-  return ret;
+// Where the stages of a construction are printed: stdout, or nowhere.
+std::ostream &stage_stream(const ParserOptions &options) {
+  static std::ostream discard(nullptr);
+  return options.verbose ? std::cout : discard;
 }
 
-std::string ParsingTable::to_string() const {
-  return epr::to_string(to_table(), [](const usize x, usize) {
-    return x == 0 ? Align::Center : Align::Left;
-  });
-}
+} // namespace
 
 OutputEntry to_output_entry(
     const std::vector<usize> &stack, const std::vector<Symbol> &symbols,
     const std::vector<Symbol> &input, const usize input_idx,
-    const std::string &action
+    const std::string &action, const SymbolTable &symbol_table
 ) {
   std::string stack_str;
   for (const auto &x : stack)
@@ -118,68 +32,216 @@ OutputEntry to_output_entry(
 
   std::string symbols_str;
   for (const auto &x : symbols)
-    symbols_str.append(x.to_string());
+    symbols_str.append(x.to_string(symbol_table));
 
   std::string input_str;
   for (usize i = input_idx; i < input.size(); ++i)
-    input_str.append(input.at(i).to_string());
+    input_str.append(input.at(i).to_string(symbol_table));
 
   return {stack_str, symbols_str, input_str, action};
 }
 
-Parser::Parser(Grammar grammar) {
+ParserTables::ParserTables(Grammar source, const ParserOptions &options) {
+  // Everything that shapes the table goes into the cache key.
+  const auto key = hash_combine(
+      hash_combine(
+          hash_combine(
+              source.content_hash(), static_cast<u64>(options.construction)
+          ),
+          static_cast<u64>(options.eliminate_unit_rules)
+      ),
+      TableFileHeader::VERSION
+  );
+  std::filesystem::path cache_path{};
+  if (!options.cache_dir.empty()) {
+    cache_path = table_cache_path(options.cache_dir, key);
+    if (std::filesystem::exists(cache_path))
+      try {
+        mapped.emplace(cache_path, key);
+      } catch (const std::exception &e) {
+        std::cerr << std::format("{}; rebuilding\n", e.what());
+      }
+  }
+
+  if (mapped) {
+    auto &out = stage_stream(options);
+    grammar = mapped->grammar();
+    view = mapped->table();
+    out << std::format(
+        "\033[1;32m==== Table Cache ==== \033[0m\nMapped {} states from {}\n\n",
+        view.rows, cache_path.string()
+    );
+  } else {
+    build_table(std::move(source), options);
+    if (!cache_path.empty())
+      try {
+        std::filesystem::create_directories(options.cache_dir);
+        write_table_file(cache_path, key, grammar, view);
+      } catch (const std::exception &e) {
+        std::cerr << std::format("Cannot cache parsing table: {}\n", e.what());
+      }
+  }
+  finish_table(options);
+}
+
+ParserTables::ParserTables(
+    Grammar source, const TableView &prebuilt, const ParserOptions &options
+) {
+  source.self_augment();
+  source.build_production_index();
+  if (prebuilt.cols != source.symbols.size() ||
+      prebuilt.terminal_count != source.symbols.terminal_count())
+    throw std::runtime_error("Prebuilt table does not match the grammar");
+  grammar = std::move(source);
+  view = prebuilt;
+  if (options.eliminate_unit_rules) {
+    table = ParsingTable(prebuilt);
+    eliminate_unit_reductions(options);
+  }
+  finish_table(options);
+}
+
+void ParserTables::eliminate_unit_reductions(const ParserOptions &options) {
+  auto &out = stage_stream(options);
+  const auto states = table.rows;
+  const auto redirected = table.eliminate_unit_reductions(grammar);
+  view = table.view();
+  out << std::format(
+      "\033[1;32m==== Unit Rule Elimination ==== \033[0m\n"
+      "{} gotos redirected, {} states -> {} states\n\n",
+      redirected, states, table.rows
+  );
+}
+
+void ParserTables::finish_table(const ParserOptions &options) {
+  auto &out = stage_stream(options);
+  const auto &symbols = grammar.symbols;
+  terminals = {};
+  for (u32 id = Grammar::END_SYMBOL.id + 1; id < symbols.terminal_count();
+       ++id) {
+    const auto &name = symbols.name(symbols.at(id));
+    if (name == "n")
+      terminals.integer = id;
+    else if (name.size() == 1)
+      terminals.punctuator[static_cast<unsigned char>(name[0])] = id;
+  }
+  rule_length.clear();
+  rule_lhs.clear();
+  for (const auto &[lhs, rhs] : grammar.production_list) {
+    rule_length.push_back(static_cast<u32>(rhs.size()));
+    rule_lhs.push_back(lhs.id);
+  }
+
+  out << std::format(
+      "\033[1;32m==== Parsing Table ==== \033[0m\n{}\n",
+      view.to_string(grammar.symbols)
+  );
+  out << std::format(
+      "{} of {} states reduce without reading the lookahead\n",
+      view.default_reduction_count(), view.rows
+  );
+  out << std::endl;
+
+  if (options.compress) {
+    compressed.emplace(view);
+    out << std::format(
+        "\033[1;32m==== Table Compression ==== \033[0m\n"
+        "{} bytes -> {} bytes ({} column classes, {} slots)\n\n",
+        view.byte_size(), compressed->byte_size(), compressed->classes,
+        compressed->entries.size()
+    );
+  }
+}
+
+void ParserTables::build_table(Grammar grammar, const ParserOptions &options) {
+  auto &out = stage_stream(options);
+  const auto construction = options.construction;
   grammar.self_augment();
   grammar.build_production_index();
-  std::cout << std::format(
+  out << std::format(
       "\033[1;32m==== Augmented Grammar ====\033[0m\n{}\n", grammar.to_string()
   );
-  std::cout << std::endl;
+  out << std::endl;
 
-  grammar.build_first_set();
-  std::cout << std::format(
-      "\033[1;32m==== FIRST Set ====\033[0m\n{}\n",
-      to_string(grammar.first_set, "FIRST")
+  grammar.build_analysis();
+  out << std::format(
+      "\033[1;32m==== FIRST & FOLLOW Set ====\033[0m\n{}\n",
+      grammar.analysis.to_string(grammar.symbols)
   );
-  std::cout << std::endl;
+  out << std::endl;
 
-  const auto dfa = Dfa(grammar);
-  std::cout << std::format(
-      "\033[1;32m==== LR(1) Sets of Items ==== \033[0m\n{}\n",
-      dfa.sets_to_string()
+  const auto dfa = Dfa::build(grammar, construction, options.threads);
+  out << std::format(
+      "\033[1;32m==== {} Sets of Items ==== \033[0m\n{}\n",
+      to_string(construction), dfa.sets_to_string(grammar)
   );
-  std::cout << std::endl;
-  std::cout << std::format(
-      "\033[1;32m==== LR(1) DFA ==== \033[0m\n{}\n", dfa.transitions_to_string()
+  out << std::endl;
+  out << std::format(
+      "\033[1;32m==== {} DFA ==== \033[0m\n{}\n", to_string(construction),
+      dfa.transitions_to_string(grammar.symbols)
   );
+  if (construction == Construction::MinimalLr1)
+    out << std::format(
+        "\033[1;32m==== State Merging ==== \033[0m\n{}\n\n",
+        dfa.merge_stats.to_string()
+    );
 
-  grammar_ = grammar;
   table = ParsingTable(dfa, grammar);
-  std::cout << std::format(
-      "\033[1;32m==== Parsing Table ==== \033[0m\n{}\n", table.to_string()
-  );
-  std::cout << std::endl;
+  view = table.view();
+  if (!table.conflicts.empty())
+    out << std::format(
+        "\033[1;32m==== Conflicts ==== \033[0m\n{}\n\n",
+        table.conflicts_to_string(grammar)
+    );
+  this->grammar = std::move(grammar);
+  if (options.eliminate_unit_rules)
+    eliminate_unit_reductions(options);
 }
 
-SymbolStream Parser::tokens_to_symbols(std::vector<Token> &&token_stream) {
-  SymbolStream buf;
-  for (const auto &token : token_stream) {
-    std::visit(
-        overloaded{
-            [&](const Integer &) {
-              buf.emplace_back("n", Symbol::Terminator);
-            },
-            [&](const Punctuator &punct) {
-              buf.emplace_back(std::string(1, punct.punct), Symbol::Terminator);
-            },
-            [](const auto &) {},
-        },
-        token
-    );
-  }
-  return buf;
+Parser::Parser(std::shared_ptr<const ParserTables> tables):
+    tables(std::move(tables)) {}
+
+Parser::Parser(Grammar grammar, const ParserOptions &options):
+    Parser(std::make_shared<const ParserTables>(std::move(grammar), options)) {}
+
+Parser::Parser(
+    Grammar grammar, const TableView &prebuilt, const ParserOptions &options
+):
+    Parser(std::make_shared<const ParserTables>(
+        std::move(grammar), prebuilt, options
+    )) {}
+
+std::optional<Symbol> ParserTables::token_to_symbol(const Token &token) const {
+  const auto terminal = [](const u32 id, const std::string_view name) {
+    if (id == 0)
+      throw std::runtime_error(std::format("Unexpected token '{}'", name));
+    return Symbol(id, Symbol::Terminator);
+  };
+
+  return std::visit(
+      overloaded{
+          [&](const Integer &) -> std::optional<Symbol> {
+            return terminal(terminals.integer, "n");
+          },
+          [&](const Punctuator &punct) -> std::optional<Symbol> {
+            return terminal(
+                terminals.punctuator[static_cast<unsigned char>(punct.punct)],
+                std::string_view(&punct.punct, 1)
+            );
+          },
+          [](const Whitespace &) -> std::optional<Symbol> {
+            return std::nullopt;
+          },
+          [](const LexError &) -> std::optional<Symbol> {
+            throw std::runtime_error("Lex error");
+          },
+      },
+      token
+  );
 }
 
-std::vector<OutputEntry> Parser::parse_expr(SymbolStream &&input) {
+std::vector<OutputEntry> Parser::parse_expr(SymbolStream &&input) const {
+  const auto &grammar = tables->grammar;
   input.emplace_back(Grammar::END_SYMBOL);
   std::vector<OutputEntry> buf = {
       {"Stack", "Symbols", "Input", "Action"}
@@ -188,18 +250,40 @@ std::vector<OutputEntry> Parser::parse_expr(SymbolStream &&input) {
   std::vector<usize> stack{0};
   std::vector<Symbol> symbols{};
   bool has_error = false;
+  // Where the last error struck. Erring again at the same input with no less
+  // on the stack means recovery went in a circle, which default reductions
+  // can cause through empty rules.
+  usize error_idx = input.size();
+  usize error_depth = 0;
+  EmptyReductionGuard empty_reductions{};
 
   for (usize input_idx = 0;;) {
     const auto &cur_state = stack.back();
     const auto &cur_symbol = input.at(input_idx);
-    const auto &action = table.get_action(cur_state, cur_symbol);
+    // A default reduction is taken without looking at `cur_symbol`.
+    const auto default_reduction = tables->view.default_reduction(cur_state);
+    const auto action = default_reduction.is_error()
+                            ? tables->get_action(cur_state, cur_symbol)
+                            : default_reduction.unpack();
 
     buf.push_back(
-        to_output_entry(stack, symbols, input, input_idx, action_str(action))
+        to_output_entry(
+            stack, symbols, input, input_idx, tables->action_str(action),
+            grammar.symbols
+        )
     );
 
     if (std::holds_alternative<Accept>(action))
       break;
+    if (const auto *reduce = std::get_if<Reduce>(&action)) {
+      const auto &rhs = grammar.production_list.at(reduce->rule).second;
+      if (!empty_reductions.reduce(
+              cur_state, stack.size(), static_cast<u32>(rhs.size())
+          )) {
+        has_error = true;
+        break;
+      }
+    }
     bool sync = false;
 
     std::visit(
@@ -208,10 +292,11 @@ std::vector<OutputEntry> Parser::parse_expr(SymbolStream &&input) {
               stack.push_back(shift.state);
               symbols.push_back(cur_symbol);
               ++input_idx;
+              empty_reductions.clear();
             },
 
             [&](const Reduce &reduce) {
-              const auto &[lhs, rhs] = grammar_.production_list.at(reduce.rule);
+              const auto &[lhs, rhs] = grammar.production_list.at(reduce.rule);
 
               for (usize _ = 0; _ < rhs.size(); ++_) {
                 stack.pop_back();
@@ -219,18 +304,23 @@ std::vector<OutputEntry> Parser::parse_expr(SymbolStream &&input) {
               }
 
               const auto &cur_top_state = stack.back();
-              const auto &next_state = table.get_action(cur_top_state, lhs);
+              const auto &next_state = tables->get_action(cur_top_state, lhs);
               stack.push_back(std::get<Goto>(next_state).state);
               symbols.push_back(lhs);
             },
 
             [&](const Error &) {
               has_error = true;
+              if (input_idx == error_idx && stack.size() >= error_depth)
+                return;
+              error_idx = input_idx;
+              error_depth = stack.size();
+              empty_reductions.clear();
               while (true) {
                 if (stack.empty() || symbols.empty())
                   break;
                 if (!std::holds_alternative<Error>(
-                        table.get_action(stack.back(), cur_symbol)
+                        tables->get_action(stack.back(), cur_symbol)
                     ))
                   break;
                 stack.pop_back();
@@ -256,14 +346,126 @@ std::vector<OutputEntry> Parser::parse_expr(SymbolStream &&input) {
   return buf;
 }
 
-void Parser::parse_src(const std::string &src) {
-  auto lexer = Lexer::with_src(src);
-  auto tokens = lexer.lex_effective();
-  auto symbols = tokens_to_symbols(std::move(tokens));
+ParseResult ParserTables::recognize(
+    const std::span<const u32> input, ParseContext<> &context
+) const {
+  const auto symbol_at = [&](const usize idx) {
+    return idx < input.size() ? input[idx] : Grammar::END_SYMBOL.id;
+  };
 
+  ParseResult result{};
+  auto &stack = context.states;
+  auto &empty_reductions = context.empty_reductions;
+  stack.assign(1, 0);
+  empty_reductions.clear();
+  usize error_idx = input.size() + 1;
+  usize error_depth = 0;
+  for (usize input_idx = 0;;) {
+    const auto lookahead = symbol_at(input_idx);
+    auto action = view.default_reduction(stack.back());
+    if (action.is_error())
+      action = action_at(stack.back(), lookahead);
+
+    switch (action.kind()) {
+      case PackedAction::Kind::Shift:
+        stack.push_back(action.value());
+        ++input_idx;
+        empty_reductions.clear();
+        break;
+      case PackedAction::Kind::Reduce: {
+        const auto rule = action.value();
+        if (!empty_reductions.reduce(
+                stack.back(), stack.size(), rule_length[rule]
+            )) {
+          if (input_idx != error_idx)
+            result.error_positions.push_back(input_idx);
+          return result;
+        }
+        stack.resize(stack.size() - rule_length[rule]);
+        stack.push_back(action_at(stack.back(), rule_lhs[rule]).value());
+        break;
+      }
+      case PackedAction::Kind::Accept:
+        result.accepted = result.error_positions.empty();
+        return result;
+      default: {
+        // The same recovery as parse_expr(), except that the bottom state is
+        // never given up.
+        if (input_idx == error_idx && stack.size() >= error_depth)
+          return result;
+        if (input_idx != error_idx)
+          result.error_positions.push_back(input_idx);
+        error_idx = input_idx;
+        error_depth = stack.size();
+        empty_reductions.clear();
+        const auto depth = stack.size();
+        while (stack.size() > 1 &&
+               action_at(stack.back(), lookahead).is_error())
+          stack.pop_back();
+        if (stack.size() == depth)
+          return result;
+      }
+    }
+  }
+}
+
+std::optional<Ast> ParserTables::build_ast(
+    const std::span<const u32> input, const std::span<const SourceSpan> spans,
+    std::pmr::memory_resource *arena, ParseContext<u32> &context
+) const {
+  AstBuilder builder(grammar, input, spans, arena);
+  const auto root = evaluate(input, builder.actions(), context);
+  if (!root)
+    return std::nullopt;
+  return std::move(builder).finish(*root);
+}
+
+void Parser::parse_src(const std::string &src, const OutputMode mode) {
+  const auto &symbol_table = tables->grammar.symbols;
+  lexer.load_src(src);
+  const auto &input = lexer.lex_terminals(tables->terminals);
+
+  if (mode == OutputMode::Value) {
+    if (!actions)
+      actions = arithmetic_actions(tables->grammar, lexer);
+    if (const auto value = tables->evaluate(input, *actions, value_context)) {
+      std::cout << std::format("Accepted, value {}", *value) << std::endl;
+      return;
+    }
+  } else if (mode == OutputMode::Ast) {
+    // The tree lives in this arena and goes with it.
+    std::array<std::byte, 16 * 1024> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+    if (const auto ast = tables->build_ast(
+            input, lexer.spans(), &arena, ast_context
+        )) {
+      std::cout << std::format(
+          "Accepted, {} nodes: {}", ast->size(),
+          ast->to_string(symbol_table, src)
+      ) << std::endl;
+      return;
+    }
+  }
+  if (mode != OutputMode::Trace) {
+    const auto result = tables->recognize(input, context);
+    std::string positions{};
+    for (const auto idx : result.error_positions) {
+      const auto id = idx < input.size() ? input[idx] : Grammar::END_SYMBOL.id;
+      positions.append(std::format(
+          " {}({})", idx, symbol_table.at(id).to_string(symbol_table)
+      ));
+    }
+    std::cout << std::format("Rejected, errors at tokens{}", positions)
+              << std::endl;
+    return;
+  }
+
+  SymbolStream symbols{};
+  for (const auto id : input)
+    symbols.push_back(symbol_table.at(id));
   std::cout << "\033[1;32m==== Token Stream ====\033[0m\n";
   for (const auto &symbol : symbols)
-    std::cout << symbol.to_string() << " ";
+    std::cout << symbol.to_string(symbol_table) << " ";
   std::cout << std::endl << std::endl;
 
   const auto table = parse_expr(std::move(symbols));
@@ -284,7 +486,13 @@ void Parser::parse_src(const std::string &src) {
   std::cout << std::endl;
 }
 
-std::string Parser::action_str(const Action &action) const {
+Action ParserTables::get_action(const usize state, const Symbol &symbol) const {
+  if (compressed)
+    return compressed->get_action(state, symbol);
+  return view.get_action(state, symbol);
+}
+
+std::string ParserTables::action_str(const Action &action) const {
   return std::visit(
       overloaded{
           [](const Error &) {
@@ -295,7 +503,10 @@ std::string Parser::action_str(const Action &action) const {
           },
           [&](const Reduce &reduce) {
             return std::format(
-                "Reduce {}", to_string(grammar_.production_list.at(reduce.rule))
+                "Reduce {}",
+                to_string(
+                    grammar.production_list.at(reduce.rule), grammar.symbols
+                )
             );
           },
           [](const Accept &) {
@@ -4,75 +4,276 @@
 #  define EPR_PARSER_PARSER_H
 
 #  include "dfa.h"
+#  include "parser/ast.h"
+#  include "parser/parsing_table.h"
+#  include "parser/semantic_actions.h"
+#  include "parser/table_file.h"
 #  include "parser/symbol.h"
 #  include "simple_lexer/lexer.h"
 #  include "util/all.h"
 
-#  include <map>
+#  include <algorithm>
+#  include <filesystem>
+#  include <memory>
+#  include <memory_resource>
+#  include <optional>
 #  include <variant>
 
 namespace epr {
 
 using SymbolStream = std::vector<Symbol>;
 
-struct Error {};
+using OutputEntry = std::vector<std::string>;
+
+OutputEntry to_output_entry(
+    const std::vector<usize> &stack, const std::vector<Symbol> &symbols,
+    const std::vector<Symbol> &input, usize input_idx,
+    const std::string &action, const SymbolTable &symbol_table
+);
 
-struct Shift {
-  usize state{};
+// Outcome of a parse without a trace. Recovery goes on after an error as in
+// Parser::parse_expr(), so every token the parser erred on is listed by its
+// index in the input, the input's length standing for its end.
+struct ParseResult {
+  bool accepted{}; // reached accept without any error
+  SmallVector<usize, 4> error_positions{};
 };
 
-struct Goto {
-  usize state{};
+// What Parser::parse_src() prints for a line.
+enum class OutputMode : u8 {
+  Value, // the value from arithmetic_actions()
+  Ast,   // the syntax tree
+  Trace, // every step of the parse
 };
 
-struct Reduce {
-  usize rule{};
+struct ParserOptions {
+  Construction construction{Construction::Lr1};
+  usize threads{1}; // workers for automaton construction
+  bool compress{false}; // parse from the row-displaced CompressedTable
+  std::filesystem::path cache_dir{}; // empty for no table cache
+  bool eliminate_unit_rules{false}; // bypass reductions by A -> B
+  bool verbose{true}; // print every stage of the construction to stdout
 };
 
-struct Accept {};
+// Stops a parse that reduces by empty rules in a circle without reading any
+// input, which a badly settled reduce/reduce conflict can cause; the stack
+// would grow until memory runs out. Between two shifts, a state that reduces
+// by an empty rule while an earlier empty reduction in the same state is
+// still on the stack repeats itself forever: the lookahead is the same and
+// nothing below that earlier state has changed.
+class EmptyReductionGuard {
+  struct Visit {
+    usize state{};
+    usize depth{}; // of the stack with `state` on top
+  };
 
-using Action = std::variant<Error, Shift, Goto, Reduce, Accept>;
+  SmallVector<Visit, 8> visits_{};
 
-std::string to_string(const Action &action);
+public:
+  // After a shift or an error, which start afresh.
+  void clear() {
+    visits_.clear();
+  }
 
-struct ParsingTable {
-  std::map<Symbol, usize> terminals{};
-  std::map<Symbol, usize> non_terminals{};
-  std::vector<std::vector<Action>> table{};
+  // Before reducing by a rule of `length` symbols in `state`, on top of a
+  // stack of `depth` states. False when the parse is going in a circle.
+  [[nodiscard]] bool
+  reduce(const usize state, const usize depth, const u32 length) {
+    if (length != 0) {
+      while (!visits_.empty() && visits_.back().depth > depth - length)
+        visits_.pop_back();
+      return true;
+    }
+    if (std::ranges::find(visits_, state, &Visit::state) != visits_.end())
+      return false;
+    visits_.push_back({state, depth});
+    return true;
+  }
+};
 
-  ParsingTable() = default;
+// Scratch stacks for one parse at a time, kept from one parse to the next so
+// that their storage is reused; shallow parses fit in the inline part and
+// never touch the heap. Each thread needs its own, while the tables it parses
+// with can be shared. `values` is only used by evaluating parses.
+template <typename Value = Void>
+struct ParseContext {
+  static constexpr usize INLINE_DEPTH = 32;
 
-  ParsingTable(const Dfa &dfa, const Grammar &grammar);
+  SmallVector<usize, INLINE_DEPTH> states{};
+  SmallVector<Value, INLINE_DEPTH> values{};
+  EmptyReductionGuard empty_reductions{};
+};
 
-  [[nodiscard]] Action get_action(usize state, const Symbol &symbol) const;
+// Everything built from a grammar to parse with it. Nothing changes once it
+// is constructed, so one instance behind a std::shared_ptr<const
+// ParserTables> serves any number of threads without locks, each bringing
+// its own ParseContext.
+struct ParserTables {
+  Grammar grammar{Grammar::END_SYMBOL};
+  ParsingTable table{}; // empty when the table was mapped from the cache
+  std::optional<MappedTable> mapped{};
+  TableView view{}; // of `table` or `mapped`
+  std::optional<CompressedTable> compressed{};
+  TerminalMap terminals{}; // for Lexer::lex_terminals()
+  // By rule, for the parse loops: the length of the right side and the id of
+  // the left side.
+  std::vector<u32> rule_length{};
+  std::vector<u32> rule_lhs{};
 
-  [[nodiscard]] Table to_table() const;
+  explicit ParserTables(Grammar source, const ParserOptions &options = {});
 
-  [[nodiscard]] std::string to_string() const;
-};
+  // Parses with a table built elsewhere from the same grammar, such as one
+  // from make_static_table(). Only the production list is built here.
+  ParserTables(
+      Grammar source, const TableView &prebuilt,
+      const ParserOptions &options = {}
+  );
 
-using OutputEntry = std::vector<std::string>;
+  // `view` may point into `table`, which a move keeps in place.
+  ParserTables(const ParserTables &rhs) = delete;
 
-OutputEntry to_output_entry(
-    const std::vector<usize> &stack, const std::vector<Symbol> &symbols,
-    const std::vector<Symbol> &input, usize input_idx, const std::string &action
-);
+  ParserTables(ParserTables &&rhs) noexcept = default;
 
-struct Parser {
-  Grammar grammar_{Grammar::END_SYMBOL};
-  ParsingTable table{};
+  ParserTables &operator=(const ParserTables &rhs) = delete;
+
+  ParserTables &operator=(ParserTables &&rhs) noexcept = default;
+
+  // Runs the whole construction, printing every stage.
+  void build_table(Grammar grammar, const ParserOptions &options);
+
+  // Runs ParsingTable::eliminate_unit_reductions() on `table`.
+  void eliminate_unit_reductions(const ParserOptions &options);
 
-  explicit Parser(Grammar grammar);
+  // Prints the table in use, compresses it if asked to and fills the
+  // members derived from the grammar.
+  void finish_table(const ParserOptions &options);
 
-  static SymbolStream tokens_to_symbols(std::vector<Token> &&token_stream);
+  // The terminal `token` stands for, or nothing for whitespace. Throws on a
+  // LexError, as Lexer::lex_terminals() does, and on a token the grammar has
+  // no terminal for.
+  [[nodiscard]] std::optional<Symbol> token_to_symbol(const Token &token) const;
 
-  std::vector<OutputEntry> parse_expr(SymbolStream &&input);
+  // Parses terminal ids, such as those from Lexer::lex_terminals(), without
+  // a trace, in time linear in the input.
+  [[nodiscard]] ParseResult
+  recognize(std::span<const u32> input, ParseContext<> &context) const;
 
-  void parse_src(const std::string &src);
+  // Parses like recognize() while running `actions` over a stack of values
+  // kept beside the state stack. Returns the value of the start symbol, or
+  // nothing at the first syntax error. Unit rules may be bypassed when the
+  // table was built with eliminate_unit_rules, so their actions may not run.
+  template <typename Value>
+  [[nodiscard]] std::optional<Value> evaluate(
+      std::span<const u32> input, const SemanticActions<Value> &actions,
+      ParseContext<Value> &context
+  ) const;
+
+  // Builds the syntax tree of `input`, whose tokens lie at `spans` in the
+  // source, with all of its storage in `arena`. Nothing on a syntax error.
+  [[nodiscard]] std::optional<Ast> build_ast(
+      std::span<const u32> input, std::span<const SourceSpan> spans,
+      std::pmr::memory_resource *arena, ParseContext<u32> &context
+  ) const;
+
+  // The cell for `state` and symbol id `col`, from the compressed table if
+  // there is one. Unchecked.
+  [[nodiscard]] PackedAction action_at(const usize state, const u32 col) const {
+    return compressed ? compressed->lookup(state, col)
+                      : view.lookup(state, col);
+  }
+
+  [[nodiscard]] Action get_action(usize state, const Symbol &symbol) const;
 
   [[nodiscard]] std::string action_str(const Action &action) const;
 };
 
+// Shared tables and this parser's own lexer and contexts, for one thread.
+// All of them are reused from one parse_src() to the next.
+struct Parser {
+  std::shared_ptr<const ParserTables> tables;
+  Lexer lexer{};
+  ParseContext<> context{};
+  ParseContext<i64> value_context{};
+  ParseContext<u32> ast_context{};
+  // arithmetic_actions() over `lexer`, made by the first evaluating parse.
+  std::optional<SemanticActions<i64>> actions{};
+
+  explicit Parser(std::shared_ptr<const ParserTables> tables);
+
+  explicit Parser(Grammar grammar, const ParserOptions &options = {});
+
+  Parser(
+      Grammar grammar, const TableView &prebuilt,
+      const ParserOptions &options = {}
+  );
+
+  // `actions` refer to `lexer`.
+  Parser(const Parser &rhs) = delete;
+
+  Parser &operator=(const Parser &rhs) = delete;
+
+  // Parses while recording every step for display, which costs time and
+  // memory quadratic in the input.
+  [[nodiscard]] std::vector<OutputEntry>
+  parse_expr(SymbolStream &&input) const;
+
+  // Prints what `mode` asks for, or the positions of the errors in `src`.
+  void parse_src(const std::string &src, OutputMode mode = OutputMode::Value);
+};
+
+template <typename Value>
+std::optional<Value> ParserTables::evaluate(
+    const std::span<const u32> input, const SemanticActions<Value> &actions,
+    ParseContext<Value> &context
+) const {
+  auto &stack = context.states;
+  auto &values = context.values;
+  stack.assign(1, 0);
+  values.clear();
+  context.empty_reductions.clear();
+  for (usize input_idx = 0;;) {
+    const auto lookahead =
+        input_idx < input.size() ? input[input_idx] : Grammar::END_SYMBOL.id;
+    auto action = view.default_reduction(stack.back());
+    if (action.is_error())
+      action = action_at(stack.back(), lookahead);
+
+    switch (action.kind()) {
+      case PackedAction::Kind::Shift:
+        stack.push_back(action.value());
+        values.push_back(
+            actions.on_shift ? actions.on_shift(input_idx) : Value{}
+        );
+        ++input_idx;
+        context.empty_reductions.clear();
+        break;
+      case PackedAction::Kind::Reduce: {
+        const auto rule = action.value();
+        const auto length = rule_length[rule];
+        if (!context.empty_reductions.reduce(
+                stack.back(), stack.size(), length
+            ))
+          return std::nullopt;
+        const auto rhs_values = std::span(values).last(length);
+        Value value{};
+        if (rule < actions.on_reduce.size() && actions.on_reduce[rule])
+          value = actions.on_reduce[rule](rhs_values);
+        else if (!rhs_values.empty())
+          value = std::move(rhs_values.front());
+        values.resize(values.size() - length);
+        values.push_back(std::move(value));
+        stack.resize(stack.size() - length);
+        stack.push_back(action_at(stack.back(), rule_lhs[rule]).value());
+        break;
+      }
+      case PackedAction::Kind::Accept:
+        return std::move(values.back());
+      default:
+        return std::nullopt;
+    }
+  }
+}
+
 } // namespace epr
 
 #endif // !EPR_PARSER_PARSER_H
@@ -0,0 +1,535 @@
+#include "parser/parsing_table.h"
+
+#include <algorithm>
+#include <format>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+
+namespace epr {
+
+using namespace std::string_literals;
+
+namespace {
+
+// find_default_reduction() on one row of a row-major table.
+[[nodiscard]] PackedAction row_default_reduction(
+    const std::span<const PackedAction> cells, const u32 cols,
+    const u32 terminal_count, const usize row
+) {
+  return find_default_reduction(
+      cells.subspan(row * cols + 1, terminal_count - 1)
+  );
+}
+
+} // namespace
+
+std::string to_string(const Action &action) {
+  return std::visit(
+      overloaded{
+          [](const Error &) {
+            return ""s;
+          },
+          [](const Shift &shift) {
+            return std::format("s{}", shift.state);
+          },
+          [](const Goto &go_to) {
+            return std::format("{}", go_to.state);
+          },
+          [](const Reduce &reduce) {
+            return std::format("r{}", reduce.rule);
+          },
+          [](const Accept &) {
+            return "acc"s;
+          },
+      },
+      action
+  );
+}
+
+PackedAction::PackedAction(const Action &action) {
+  const auto pack = [](const Kind kind, const usize value) {
+    if (value > MAX_VALUE)
+      throw std::runtime_error("Parsing table too large to pack");
+    return PackedAction(kind, static_cast<u32>(value));
+  };
+  *this = std::visit(
+      overloaded{
+          [](const Error &) {
+            return PackedAction{};
+          },
+          [&](const Shift &shift) {
+            return pack(Kind::Shift, shift.state);
+          },
+          [&](const Goto &go_to) {
+            return pack(Kind::Goto, go_to.state);
+          },
+          [&](const Reduce &reduce) {
+            return pack(Kind::Reduce, reduce.rule);
+          },
+          [](const Accept &) {
+            return PackedAction(Kind::Accept, 0);
+          },
+      },
+      action
+  );
+}
+
+Action PackedAction::unpack() const {
+  switch (kind()) {
+    case Kind::Shift:
+      return Shift{value()};
+    case Kind::Goto:
+      return Goto{value()};
+    case Kind::Reduce:
+      return Reduce{value()};
+    case Kind::Accept:
+      return Accept{};
+    default:
+      return Error{};
+  }
+}
+
+std::string Conflict::to_string(const Grammar &grammar) const {
+  const auto action_str = [&](const PackedAction action) {
+    switch (action.kind()) {
+      case PackedAction::Kind::Shift:
+        return std::format("shift {}", action.value());
+      case PackedAction::Kind::Reduce:
+        return std::format(
+            "reduce {}",
+            epr::to_string(
+                grammar.production_list[action.value()], grammar.symbols
+            )
+        );
+      case PackedAction::Kind::Accept:
+        return "accept"s;
+      default:
+        return "error"s;
+    }
+  };
+
+  std::string buf = std::format(
+      "I{} on {}: ", state, lookahead.to_string(grammar.symbols)
+  );
+  for (const auto &action : actions)
+    buf.append(action_str(action)).append(" vs ");
+  buf.resize(buf.size() - 4);
+  buf.append(std::format(
+      "; kept {} by {}", action_str(chosen),
+      by_precedence ? "precedence" : "default"
+  ));
+  return buf;
+}
+
+ParsingTable::ParsingTable(const Dfa &dfa, const Grammar &grammar):
+    rows(static_cast<u32>(dfa.states.size())),
+    cols(grammar.symbols.size()),
+    terminal_count(grammar.symbols.terminal_count()),
+    cells(static_cast<usize>(rows) * cols) {
+  std::map<u32, std::vector<PackedAction>> completions{}; // by lookahead
+  for (usize row_idx = 0; row_idx < rows; ++row_idx) {
+    const auto row = cells.begin() + row_idx * cols;
+
+    // shift and goto
+    for (const auto &[symbol, next_state_idx] : dfa.transitions.at(row_idx))
+      if (symbol.type == Symbol::Type::Terminator)
+        row[symbol.id] = PackedAction(Shift{next_state_idx});
+      else
+        row[symbol.id] = PackedAction(Goto{next_state_idx});
+
+    // accept and reduce, which may collide with a shift or with each other
+    completions.clear();
+    for (const auto &item : dfa.states[row_idx].items)
+      if (item.is_complete(grammar)) {
+        if (item.production(grammar).first == grammar.start_symbol)
+          completions[Grammar::END_SYMBOL.id].emplace_back(Accept{});
+        else
+          completions[item.lookahead().id].emplace_back(Reduce{item.rule()});
+      }
+
+    for (auto &[lookahead, candidates] : completions) {
+      auto &cell = row[lookahead];
+      std::ranges::sort(candidates, {}, [](const PackedAction action) {
+        return std::pair(action.kind(), action.value());
+      });
+      candidates.erase(
+          std::ranges::unique(candidates).begin(), candidates.end()
+      );
+      if (candidates.size() == 1 && cell.is_error()) {
+        cell = candidates.front();
+        continue;
+      }
+
+      // Reductions sort before accept, which beats them all; among them the
+      // rule declared first wins.
+      const auto completion =
+          candidates.back().kind() == PackedAction::Kind::Accept
+              ? candidates.back()
+              : std::ranges::min(
+                    candidates, {},
+                    [&](const PackedAction action) {
+                      return grammar.rule_declaration[action.value()];
+                    }
+                );
+      Conflict conflict{
+          cell.is_error() ? Conflict::Kind::ReduceReduce
+                          : Conflict::Kind::ShiftReduce,
+          row_idx, grammar.symbols.at(lookahead)
+      };
+      if (!cell.is_error())
+        conflict.actions.push_back(cell);
+      conflict.actions.insert(
+          conflict.actions.end(), candidates.begin(), candidates.end()
+      );
+
+      if (cell.is_error())
+        cell = completion;
+      else if (completion.kind() == PackedAction::Kind::Reduce) {
+        const auto resolution = resolve_by_precedence(
+            grammar.rule_precedence[completion.value()],
+            grammar.precedence_of(conflict.lookahead)
+        );
+        conflict.by_precedence = resolution && candidates.size() == 1;
+        if (resolution == PackedAction::Kind::Reduce)
+          cell = completion;
+        else if (resolution == PackedAction::Kind::Error)
+          cell = PackedAction::precedence_error();
+      }
+      conflict.chosen = cell;
+      conflicts.push_back(std::move(conflict));
+    }
+  }
+
+  default_reductions.resize(rows);
+  for (usize row = 0; row < rows; ++row)
+    default_reductions[row] =
+        row_default_reduction(cells, cols, terminal_count, row);
+  for (const auto &conflict : conflicts)
+    if (conflict.chosen.is_error())
+      default_reductions[conflict.state] = {};
+}
+
+std::string ParsingTable::conflicts_to_string(const Grammar &grammar) const {
+  std::string buf{};
+  usize by_default = 0;
+  for (const auto &conflict : conflicts) {
+    buf.append(conflict.to_string(grammar)).push_back('\n');
+    by_default += !conflict.by_precedence;
+  }
+  buf.append(std::format(
+      "{} conflicts, {} resolved by precedence, {} by default",
+      conflicts.size(), conflicts.size() - by_default, by_default
+  ));
+  return buf;
+}
+
+ParsingTable::ParsingTable(const TableView &table):
+    rows(table.rows), cols(table.cols), terminal_count(table.terminal_count),
+    cells(table.cells.begin(), table.cells.end()),
+    default_reductions(
+        table.default_reductions.begin(), table.default_reductions.end()
+    ) {
+  if (default_reductions.empty())
+    for (usize row = 0; row < rows; ++row)
+      default_reductions.push_back(
+          row_default_reduction(cells, cols, terminal_count, row)
+      );
+}
+
+usize ParsingTable::eliminate_unit_reductions(const Grammar &grammar) {
+  const auto &production_list = grammar.production_list;
+  const auto is_unit = [&](const PackedAction action) {
+    if (action.kind() != PackedAction::Kind::Reduce)
+      return false;
+    const auto &[lhs, rhs] = production_list[action.value()];
+    return rhs.size() == 1 && rhs[0].type == Symbol::NonTerminator &&
+           lhs != grammar.start_symbol;
+  };
+  const auto cell = [&](const usize row, const u32 col) -> PackedAction & {
+    return cells[row * cols + col];
+  };
+
+  // Non-terminals ordered so that A comes before B for every unit rule
+  // A -> B: the goto on A is then final by the time the goto on B needs it.
+  // Symbols on a cycle of unit rules, which only an ambiguous grammar has,
+  // go last and may see a goto not yet redirected, which is still correct.
+  std::vector<u32> unit_in(cols);
+  std::vector<std::vector<u32>> unit_out(cols);
+  for (u32 rule = 0; rule < production_list.size(); ++rule)
+    if (is_unit(PackedAction(PackedAction::Kind::Reduce, rule))) {
+      const auto &[lhs, rhs] = production_list[rule];
+      unit_out[lhs.id].push_back(rhs[0].id);
+      ++unit_in[rhs[0].id];
+    }
+  std::vector<u32> order{};
+  for (u32 col = terminal_count; col < cols; ++col)
+    if (unit_in[col] == 0)
+      order.push_back(col);
+  for (usize idx = 0; idx < order.size(); ++idx)
+    for (const auto next : unit_out[order[idx]])
+      if (--unit_in[next] == 0)
+        order.push_back(next);
+  for (u32 col = terminal_count; col < cols; ++col)
+    if (unit_in[col] != 0)
+      order.push_back(col);
+
+  // A row that precedence denied a default reduction passes that on to any
+  // row merged from it.
+  std::vector<u8> vetoed(rows);
+  for (usize row = 0; row < rows; ++row)
+    vetoed[row] =
+        default_reductions[row].is_error() &&
+        !row_default_reduction(cells, cols, terminal_count, row).is_error();
+
+  // New rows are appended as they are made, and redirected in turn; equal
+  // ones are shared.
+  std::map<std::vector<u32>, u32> merged_rows{};
+  std::vector<PackedAction> merged(cols);
+  usize redirected = 0;
+  for (usize row = 0; row < rows; ++row)
+    for (const auto col : order) {
+      const auto go_to = cell(row, col);
+      if (go_to.kind() != PackedAction::Kind::Goto)
+        continue;
+      const auto target = go_to.value();
+      std::ranges::copy(
+          std::span(cells).subspan(target * cols, cols), merged.begin()
+      );
+
+      bool bypassed = false;
+      bool clash = false;
+      bool merged_vetoed = vetoed[target];
+      for (u32 lookahead = 1; lookahead < terminal_count && !clash;
+           ++lookahead) {
+        const auto action = cell(target, lookahead);
+        if (!is_unit(action))
+          continue;
+        const auto lhs_goto =
+            cell(row, production_list[action.value()].first.id);
+        clash = lhs_goto.kind() != PackedAction::Kind::Goto;
+        if (clash)
+          break;
+        const auto other = lhs_goto.value();
+        merged[lookahead] = cell(other, lookahead);
+        merged_vetoed = merged_vetoed || vetoed[other];
+        bypassed = true;
+        for (auto symbol = terminal_count; symbol < cols && !clash; ++symbol) {
+          const auto theirs = cell(other, symbol);
+          auto &ours = merged[symbol];
+          if (ours.is_error())
+            ours = theirs;
+          else
+            clash = !theirs.is_error() && theirs != ours;
+        }
+      }
+      if (!bypassed || clash)
+        continue;
+
+      std::vector<u32> key(merged.size());
+      std::ranges::transform(merged, key.begin(), &PackedAction::bits);
+      const auto [it, inserted] = merged_rows.try_emplace(std::move(key), rows);
+      if (inserted) {
+        cells.insert(cells.end(), merged.begin(), merged.end());
+        vetoed.push_back(merged_vetoed);
+        ++rows;
+      } else if (merged_vetoed) {
+        vetoed[it->second] = true;
+      }
+      cell(row, col) = PackedAction(PackedAction::Kind::Goto, it->second);
+      ++redirected;
+    }
+
+  // Keep the rows still reachable from state 0, in their present order.
+  constexpr auto UNREACHED = ~u32{};
+  std::vector<u32> new_id(rows, UNREACHED);
+  std::vector<u32> pending{0};
+  new_id[0] = 0;
+  while (!pending.empty()) {
+    const auto row = pending.back();
+    pending.pop_back();
+    for (u32 col = 1; col < cols; ++col)
+      if (const auto action = cell(row, col);
+          (action.kind() == PackedAction::Kind::Shift ||
+           action.kind() == PackedAction::Kind::Goto) &&
+          new_id[action.value()] == UNREACHED) {
+        new_id[action.value()] = 0;
+        pending.push_back(action.value());
+      }
+  }
+  u32 kept = 0;
+  for (auto &id : new_id)
+    if (id != UNREACHED)
+      id = kept++;
+
+  std::vector<PackedAction> kept_cells{};
+  kept_cells.reserve(static_cast<usize>(kept) * cols);
+  for (u32 row = 0; row < rows; ++row) {
+    if (new_id[row] == UNREACHED)
+      continue;
+    for (u32 col = 0; col < cols; ++col) {
+      auto action = cell(row, col);
+      if (action.kind() == PackedAction::Kind::Shift ||
+          action.kind() == PackedAction::Kind::Goto)
+        action = PackedAction(action.kind(), new_id[action.value()]);
+      kept_cells.push_back(action);
+    }
+  }
+  cells = std::move(kept_cells);
+  rows = kept;
+  default_reductions.clear();
+  for (u32 row = 0; row < new_id.size(); ++row)
+    if (new_id[row] != UNREACHED)
+      default_reductions.push_back(
+          vetoed[row] ? PackedAction{}
+                      : row_default_reduction(
+                            cells, cols, terminal_count, new_id[row]
+                        )
+      );
+  return redirected;
+}
+
+Action TableView::get_action(const usize state, const Symbol &symbol) const {
+  if (state >= rows || symbol.id >= cols)
+    throw std::out_of_range("Parsing table index out of range");
+  return lookup(state, symbol.id).unpack();
+}
+
+usize TableView::default_reduction_count() const {
+  return static_cast<usize>(std::ranges::count_if(
+      default_reductions,
+      [](const PackedAction action) {
+        return !action.is_error();
+      }
+  ));
+}
+
+usize TableView::byte_size() const {
+  return cells.size() * sizeof(PackedAction);
+}
+
+Table TableView::to_table(const SymbolTable &symbols) const {
+  Table ret;
+  ret.resize(rows + 1);
+
+  { // header
+    ret[0].resize(symbols.size());
+    for (u32 id = 1; id < symbols.size(); ++id)
+      ret[0][id] = symbols.at(id).to_string(symbols);
+  }
+
+  // body
+  for (usize i = 0; i < rows; ++i) {
+    ret[i + 1].resize(cols);
+    ret[i + 1][0] = std::format("I{}", i);
+    for (u32 j = 1; j < cols; ++j)
+      ret[i + 1][j] = epr::to_string(lookup(i, j).unpack());
+  }
+
+  return ret;
+}
+
+std::string TableView::to_string(const SymbolTable &symbols) const {
+  return epr::to_string(to_table(symbols), [](const usize x, usize) {
+    return x == 0 ? Align::Center : Align::Left;
+  });
+}
+
+CompressedTable::CompressedTable(const TableView &table):
+    rows(table.rows), column_class(table.cols), defaults(table.rows),
+    base(table.rows) {
+  // Column classes: equal terminal columns collapse into one class, every
+  // non-terminal column keeps its own. Column 0 is never looked up and
+  // borrows class 0.
+  std::map<std::vector<u32>, u32> terminal_classes{};
+  std::vector<u32> representative{};
+  std::vector<u32> column(rows);
+  for (u32 col = 1; col < table.cols; ++col) {
+    if (col < table.terminal_count) {
+      for (u32 row = 0; row < rows; ++row)
+        column[row] = table.lookup(row, col).bits;
+      const auto [it, inserted] = terminal_classes.try_emplace(column, classes);
+      if (!inserted) {
+        column_class[col] = it->second;
+        continue;
+      }
+    }
+    column_class[col] = classes++;
+    representative.push_back(col);
+  }
+
+  // Default reductions: the most frequent reduce of each row, ties going to
+  // the lower rule.
+  std::map<u32, u32> reduce_count{};
+  for (u32 row = 0; row < rows; ++row) {
+    reduce_count.clear();
+    for (u32 col = 1; col < table.terminal_count; ++col)
+      if (const auto action = table.lookup(row, col);
+          action.kind() == PackedAction::Kind::Reduce)
+        ++reduce_count[action.value()];
+    u32 best = 0;
+    for (const auto &[rule, count] : reduce_count)
+      if (count > best) {
+        best = count;
+        defaults[row] = PackedAction(PackedAction::Kind::Reduce, rule);
+      }
+  }
+
+  // Rows with the most entries are placed first, where the array is still
+  // sparse, each at the lowest base whose slots are all free.
+  std::vector<std::vector<u32>> row_classes(rows);
+  for (u32 row = 0; row < rows; ++row)
+    for (u32 cls = 0; cls < classes; ++cls) {
+      const auto action = table.lookup(row, representative[cls]);
+      if (action != PackedAction{} && action != defaults[row])
+        row_classes[row].push_back(cls);
+    }
+  std::vector<u32> order(rows);
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::stable_sort(order, [&](const u32 lhs, const u32 rhs) {
+    return row_classes[lhs].size() > row_classes[rhs].size();
+  });
+
+  check.assign(classes, NO_ROW);
+  entries.assign(classes, PackedAction{});
+  usize first_free = 0;
+  for (const auto row : order) {
+    const auto &placed = row_classes[row];
+    while (first_free < check.size() && check[first_free] != NO_ROW)
+      ++first_free;
+    const auto fits = [&](const usize offset) {
+      return std::ranges::all_of(placed, [&](const u32 cls) {
+        return offset + cls >= check.size() || check[offset + cls] == NO_ROW;
+      });
+    };
+    usize offset = 0;
+    if (!placed.empty())
+      offset = first_free - std::min<usize>(first_free, placed.front());
+    while (!fits(offset))
+      ++offset;
+    if (offset + classes > check.size()) {
+      check.resize(offset + classes, NO_ROW);
+      entries.resize(offset + classes);
+    }
+    base[row] = static_cast<u32>(offset);
+    for (const auto cls : placed) {
+      check[offset + cls] = row;
+      entries[offset + cls] = table.lookup(row, representative[cls]);
+    }
+  }
+}
+
+Action
+CompressedTable::get_action(const usize state, const Symbol &symbol) const {
+  if (state >= rows || symbol.id >= column_class.size())
+    throw std::out_of_range("Parsing table index out of range");
+  return lookup(state, symbol.id).unpack();
+}
+
+usize CompressedTable::byte_size() const {
+  return column_class.size() * sizeof(u32) +
+         defaults.size() * sizeof(PackedAction) + base.size() * sizeof(u32) +
+         check.size() * sizeof(u32) + entries.size() * sizeof(PackedAction);
+}
+
+} // namespace epr
@@ -0,0 +1,239 @@
+#pragma once
+
+#ifndef EPR_PARSER_PARSING_TABLE_H
+#  define EPR_PARSER_PARSING_TABLE_H
+
+#  include "parser/dfa.h"
+#  include "parser/grammar.h"
+#  include "parser/symbol.h"
+#  include "util/all.h"
+
+#  include <optional>
+#  include <span>
+#  include <variant>
+#  include <vector>
+
+namespace epr {
+
+struct Error {};
+
+struct Shift {
+  usize state{};
+};
+
+struct Goto {
+  usize state{};
+};
+
+struct Reduce {
+  usize rule{};
+};
+
+struct Accept {};
+
+using Action = std::variant<Error, Shift, Goto, Reduce, Accept>;
+
+std::string to_string(const Action &action);
+
+// An action in one 32-bit word: the kind in the low 3 bits and the target
+// state or rule above them. The all-zero word is Error; so is
+// precedence_error(), which only differs in its bits.
+struct PackedAction {
+  enum class Kind : u8 { Error, Shift, Goto, Reduce, Accept };
+
+  u32 bits{};
+
+  static constexpr u32 KIND_BITS = 3;
+  static constexpr u32 MAX_VALUE = ~u32{} >> KIND_BITS;
+
+  constexpr PackedAction() = default;
+
+  constexpr PackedAction(const Kind kind, const u32 value):
+      bits(value << KIND_BITS | static_cast<u32>(kind)) {}
+
+  explicit PackedAction(const Action &action);
+
+  // The error that %nonassoc leaves in a cell. Unlike a lookahead no item
+  // expects, it is not caught in a later state if a reduction is taken in
+  // its place, so tables that fill errors with a default must keep it.
+  [[nodiscard]] static constexpr PackedAction precedence_error() {
+    return {Kind::Error, 1};
+  }
+
+  [[nodiscard]] constexpr Kind kind() const {
+    return static_cast<Kind>(bits & ((1u << KIND_BITS) - 1));
+  }
+
+  [[nodiscard]] constexpr u32 value() const {
+    return bits >> KIND_BITS;
+  }
+
+  [[nodiscard]] constexpr bool is_error() const {
+    return kind() == Kind::Error;
+  }
+
+  [[nodiscard]] Action unpack() const;
+
+  constexpr bool operator==(const PackedAction &) const = default;
+};
+
+// Settles a shift/reduce conflict between a rule and a lookahead the way
+// yacc does: the tighter precedence wins, and equal levels go by their
+// associativity, with Kind::Error for %nonassoc. Nothing when either side has
+// no precedence.
+[[nodiscard]] constexpr std::optional<PackedAction::Kind>
+resolve_by_precedence(const Precedence &rule, const Precedence &lookahead) {
+  if (rule.level == 0 || lookahead.level == 0)
+    return std::nullopt;
+  if (rule.level != lookahead.level)
+    return rule.level > lookahead.level ? PackedAction::Kind::Reduce
+                                        : PackedAction::Kind::Shift;
+  switch (rule.associativity) {
+    case Associativity::Left:
+      return PackedAction::Kind::Reduce;
+    case Associativity::Right:
+      return PackedAction::Kind::Shift;
+    default:
+      return PackedAction::Kind::Error;
+  }
+}
+
+// The reduction a row performs on every terminal it does not reject, given
+// the row's terminal cells; Error when it also shifts or accepts, or reduces
+// by more than one rule. A driver may take it without reading the lookahead.
+// An invalid lookahead is then rejected in a later state, before it is
+// shifted.
+[[nodiscard]] constexpr PackedAction
+find_default_reduction(const std::span<const PackedAction> terminals) {
+  PackedAction ret{};
+  for (const auto action : terminals) {
+    if (action.is_error())
+      continue;
+    if (action.kind() != PackedAction::Kind::Reduce ||
+        (!ret.is_error() && action != ret))
+      return {};
+    ret = action;
+  }
+  return ret;
+}
+
+// A cell that the automaton gives more than one action, and the action kept.
+// Without precedence to go by, a shift beats a reduction, and of two rules
+// the one declared first in the grammar text wins, as in yacc.
+struct Conflict {
+  enum class Kind : u8 { ShiftReduce, ReduceReduce };
+
+  Kind kind{};
+  usize state{};
+  Symbol lookahead{};
+  std::vector<PackedAction> actions{}; // the shift, if any, comes first
+  PackedAction chosen{};
+  bool by_precedence{};
+
+  [[nodiscard]] std::string to_string(const Grammar &grammar) const;
+};
+
+// Read-only view of a row-major rows × cols array of packed actions, owned
+// by a ParsingTable or mapped from a table file. Columns are indexed by symbol
+// id; column 0 (the empty symbol) is unused. `default_reductions` holds the
+// reduction of each row that may be taken without the lookahead, or Error; it
+// may be left empty.
+struct TableView {
+  u32 rows{};
+  u32 cols{};
+  u32 terminal_count{};
+  std::span<const PackedAction> cells{};
+  std::span<const PackedAction> default_reductions{};
+
+  [[nodiscard]] PackedAction lookup(const usize state, const u32 col) const {
+    return cells[state * cols + col];
+  }
+
+  [[nodiscard]] PackedAction default_reduction(const usize state) const {
+    return default_reductions.empty() ? PackedAction{}
+                                      : default_reductions[state];
+  }
+
+  [[nodiscard]] usize default_reduction_count() const;
+
+  [[nodiscard]] Action get_action(usize state, const Symbol &symbol) const;
+
+  [[nodiscard]] usize byte_size() const;
+
+  [[nodiscard]] Table to_table(const SymbolTable &symbols) const;
+
+  [[nodiscard]] std::string to_string(const SymbolTable &symbols) const;
+};
+
+struct ParsingTable {
+  u32 rows{};
+  u32 cols{};
+  u32 terminal_count{};
+  std::vector<PackedAction> cells{};
+  // By row. A row where precedence left an error, as %nonassoc does, gets
+  // none, since a default reduction would skip over that error.
+  std::vector<PackedAction> default_reductions{};
+  std::vector<Conflict> conflicts{};
+
+  ParsingTable() = default;
+
+  ParsingTable(const Dfa &dfa, const Grammar &grammar);
+
+  // A copy of a table built elsewhere, without its conflicts. Its default
+  // reductions are copied when it has them.
+  explicit ParsingTable(const TableView &table);
+
+  [[nodiscard]] std::string conflicts_to_string(const Grammar &grammar) const;
+
+  // Takes reductions by unit rules A -> B out of the automaton. The goto of a
+  // state p on B is redirected to a new state that, on the lookaheads where
+  // the old target reduced by A -> B, acts as the goto of p on A would, and
+  // elsewhere as the old target. Chains of unit rules collapse into one goto,
+  // and states left unreachable are dropped. The language is unchanged, but
+  // the parse skips the unit reductions, so nothing may hang on them. A goto
+  // is left alone when the two states would need different gotos on the same
+  // symbol. Conflicts keep the state numbers of the original automaton.
+  // Returns how many gotos were redirected.
+  usize eliminate_unit_reductions(const Grammar &grammar);
+
+  [[nodiscard]] TableView view() const {
+    return {rows, cols, terminal_count, cells, default_reductions};
+  }
+};
+
+// A parsing table squeezed by row displacement. Terminal columns with the same
+// contents share one column class. Each row's most frequent reduction becomes
+// its default and is dropped, along with its errors, so the default also
+// fires on lookaheads that would have been errors: the error is then caught
+// before the lookahead is shifted instead. Precedence errors would not be
+// caught that way and stay as entries. The remaining entries of every row are
+// overlaid in one array, each row shifted by `base` until it lands on free
+// slots, and `check` records which row owns a slot.
+struct CompressedTable {
+  static constexpr u32 NO_ROW = ~u32{};
+
+  u32 rows{};
+  u32 classes{};
+  std::vector<u32> column_class{}; // by symbol id
+  std::vector<PackedAction> defaults{};
+  std::vector<u32> base{};
+  std::vector<u32> check{};
+  std::vector<PackedAction> entries{};
+
+  CompressedTable() = default;
+
+  explicit CompressedTable(const TableView &table);
+
+  [[nodiscard]] PackedAction lookup(const usize state, const u32 col) const {
+    const auto slot = base[state] + column_class[col];
+    return check[slot] == state ? entries[slot] : defaults[state];
+  }
+
+  [[nodiscard]] Action get_action(usize state, const Symbol &symbol) const;
+
+  [[nodiscard]] usize byte_size() const;
+};
+
+} // namespace epr
+
+#endif // !EPR_PARSER_PARSING_TABLE_H
@@ -0,0 +1,105 @@
+#include "parser/push_parser.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace epr {
+
+PushParser::PushParser(std::shared_ptr<const ParserTables> tables):
+    tables_(std::move(tables)) {
+  reset();
+}
+
+void PushParser::reset() {
+  context_.states.assign(1, 0);
+  context_.empty_reductions.clear();
+  result_ = {};
+  input_idx_ = 0;
+  error_idx_ = static_cast<usize>(-1);
+  error_depth_ = 0;
+  done_ = false;
+}
+
+void PushParser::step(const u32 lookahead) {
+  const auto &tables = *tables_;
+  auto &stack = context_.states;
+  auto &empty_reductions = context_.empty_reductions;
+  while (!done_) {
+    auto action = tables.view.default_reduction(stack.back());
+    if (action.is_error())
+      action = tables.action_at(stack.back(), lookahead);
+
+    switch (action.kind()) {
+      case PackedAction::Kind::Shift:
+        stack.push_back(action.value());
+        ++input_idx_;
+        empty_reductions.clear();
+        return;
+      case PackedAction::Kind::Reduce: {
+        const auto rule = action.value();
+        if (!empty_reductions.reduce(
+                stack.back(), stack.size(), tables.rule_length[rule]
+            )) {
+          if (input_idx_ != error_idx_)
+            result_.error_positions.push_back(input_idx_);
+          done_ = true;
+          break;
+        }
+        stack.resize(stack.size() - tables.rule_length[rule]);
+        stack.push_back(
+            tables.action_at(stack.back(), tables.rule_lhs[rule]).value()
+        );
+        break;
+      }
+      case PackedAction::Kind::Accept:
+        result_.accepted = result_.error_positions.empty();
+        done_ = true;
+        break;
+      default: {
+        if (input_idx_ == error_idx_ && stack.size() >= error_depth_) {
+          done_ = true;
+          break;
+        }
+        if (input_idx_ != error_idx_)
+          result_.error_positions.push_back(input_idx_);
+        error_idx_ = input_idx_;
+        error_depth_ = stack.size();
+        empty_reductions.clear();
+        const auto depth = stack.size();
+        while (stack.size() > 1 &&
+               tables.action_at(stack.back(), lookahead).is_error())
+          stack.pop_back();
+        if (stack.size() == depth)
+          done_ = true;
+      }
+    }
+  }
+}
+
+void PushParser::feed(const Symbol symbol) {
+  if (symbol.type != Symbol::Terminator ||
+      symbol.id <= Grammar::END_SYMBOL.id ||
+      symbol.id >= tables_->view.terminal_count)
+    throw std::runtime_error("PushParser::feed() takes input terminals only");
+  step(symbol.id);
+}
+
+void PushParser::feed(const Token &token) {
+  if (const auto symbol = tables_->token_to_symbol(token))
+    feed(*symbol);
+}
+
+void PushParser::feed(const std::span<const Token> tokens) {
+  // Once done, tokens are still checked, so that a lex error anywhere in the
+  // batch throws as it does when a whole line is lexed before parsing.
+  for (const auto &token : tokens)
+    feed(token);
+}
+
+const ParseResult &PushParser::finish() {
+  step(Grammar::END_SYMBOL.id);
+  done_ = true;
+  return result_;
+}
+
+} // namespace epr
@@ -0,0 +1,63 @@
+#pragma once
+
+#ifndef EPR_PARSER_PUSH_PARSER_H
+#  define EPR_PARSER_PUSH_PARSER_H
+
+#  include "parser/parser.h"
+#  include "parser/symbol.h"
+#  include "simple_lexer/token.h"
+#  include "util/all.h"
+
+#  include <memory>
+#  include <span>
+
+namespace epr {
+
+// A parse driven by its caller: tokens are fed as they arrive, in as many
+// calls as it takes, and finish() supplies the end of the input. Each token
+// is taken as far as its shift before feed() returns and is not kept, so
+// memory grows with the depth of the parse stack only. Errors are recovered
+// from as in ParserTables::recognize(), with the same result.
+class PushParser {
+  std::shared_ptr<const ParserTables> tables_;
+  ParseContext<> context_{};
+  ParseResult result_{};
+  usize input_idx_{}; // tokens shifted or erred on so far
+  // Where the last error struck; see ParserTables::recognize().
+  usize error_idx_{};
+  usize error_depth_{};
+  bool done_{}; // accepted, or stopped by an error it cannot recover from
+
+  // Runs the parse until `lookahead` is shifted or the parse is over.
+  void step(u32 lookahead);
+
+public:
+  explicit PushParser(std::shared_ptr<const ParserTables> tables);
+
+  // Starts over on a new input, keeping the stack storage.
+  void reset();
+
+  // Takes terminal `symbol`, which must not be the end marker.
+  void feed(Symbol symbol);
+
+  // Takes the terminal `token` stands for and skips whitespace. Throws on a
+  // LexError and on a token the grammar has no terminal for, also once the
+  // outcome is settled.
+  void feed(const Token &token);
+
+  void feed(std::span<const Token> tokens);
+
+  // Ends the input and returns the outcome; feed() after it is ignored until
+  // reset(). Error positions count the tokens fed, whitespace excluded.
+  [[nodiscard]] const ParseResult &finish();
+
+  // Whether the outcome is already settled, so that the rest of the input
+  // can be dropped.
+  [[nodiscard]] bool done() const {
+    return done_;
+  }
+};
+
+} // namespace epr
+
+#endif // !EPR_PARSER_PUSH_PARSER_H
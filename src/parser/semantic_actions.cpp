@@ -0,0 +1,111 @@
+#include "parser/semantic_actions.h"
+
+#include <format>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+namespace epr {
+
+namespace {
+
+using OnReduce = SemanticActions<i64>::OnReduce;
+
+[[nodiscard]] std::runtime_error overflow() {
+  return std::runtime_error("Integer overflow");
+}
+
+[[nodiscard]] OnReduce binary_action(const std::string_view op) {
+  if (op == "+")
+    return [](const std::span<i64> rhs) {
+      i64 ret{};
+      if (__builtin_add_overflow(rhs[0], rhs[2], &ret))
+        throw overflow();
+      return ret;
+    };
+  if (op == "-")
+    return [](const std::span<i64> rhs) {
+      i64 ret{};
+      if (__builtin_sub_overflow(rhs[0], rhs[2], &ret))
+        throw overflow();
+      return ret;
+    };
+  if (op == "*")
+    return [](const std::span<i64> rhs) {
+      i64 ret{};
+      if (__builtin_mul_overflow(rhs[0], rhs[2], &ret))
+        throw overflow();
+      return ret;
+    };
+  if (op == "/")
+    return [](const std::span<i64> rhs) {
+      if (rhs[2] == 0)
+        throw std::runtime_error("Division by zero");
+      if (rhs[2] == -1 && rhs[0] == std::numeric_limits<i64>::min())
+        throw overflow();
+      return rhs[0] / rhs[2];
+    };
+  return {};
+}
+
+// `value` of the token of `src` at `span` as an i64, where nothing stands
+// for a number too wide for 64 bits.
+[[nodiscard]] i64 signed_value(
+    const std::optional<u64> value, const std::string_view src,
+    const SourceSpan span
+) {
+  if (!value || *value > static_cast<u64>(std::numeric_limits<i64>::max()))
+    throw std::runtime_error(std::format(
+        "Integer {} out of range", src.substr(span.begin, span.end - span.begin)
+    ));
+  return static_cast<i64>(*value);
+}
+
+[[nodiscard]] std::vector<OnReduce>
+arithmetic_reductions(const Grammar &grammar) {
+  std::vector<OnReduce> ret{};
+  const auto &symbols = grammar.symbols;
+  const auto is_terminal = [&](const Symbol &symbol,
+                               const std::string_view name) {
+    return symbol.type == Symbol::Terminator && symbols.name(symbol) == name;
+  };
+  const auto is_nonterminal = [](const Symbol &symbol) {
+    return symbol.type == Symbol::NonTerminator;
+  };
+  for (const auto &production : grammar.production_list) {
+    const auto &rhs = production.second;
+    OnReduce action{};
+    if (rhs.size() == 3 && is_terminal(rhs[0], "(") &&
+        is_terminal(rhs[2], ")"))
+      action = [](const std::span<i64> rhs) {
+        return rhs[1];
+      };
+    else if (rhs.size() == 3 && is_nonterminal(rhs[0]) &&
+             is_nonterminal(rhs[2]) && rhs[1].type == Symbol::Terminator)
+      action = binary_action(symbols.name(rhs[1]));
+    if (!action && rhs.size() != 1)
+      throw std::runtime_error(std::format(
+          "No arithmetic meaning for {}", to_string(production, symbols)
+      ));
+    ret.push_back(std::move(action));
+  }
+  return ret;
+}
+
+} // namespace
+
+SemanticActions<i64>
+arithmetic_actions(const Grammar &grammar, const Lexer &lexer) {
+  return {
+      [&lexer](const usize input_idx) {
+        return signed_value(
+            lexer.values()[input_idx], lexer.source(),
+            lexer.spans()[input_idx]
+        );
+      },
+      arithmetic_reductions(grammar)
+  };
+}
+
+} // namespace epr
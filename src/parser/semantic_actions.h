@@ -0,0 +1,44 @@
+#pragma once
+
+#ifndef EPR_PARSER_SEMANTIC_ACTIONS_H
+#  define EPR_PARSER_SEMANTIC_ACTIONS_H
+
+#  include "parser/grammar.h"
+#  include "simple_lexer/lexer.h"
+#  include "util/all.h"
+
+#  include <functional>
+#  include <span>
+#  include <vector>
+
+namespace epr {
+
+// What Parser::evaluate() computes. `on_shift` makes the value of the
+// terminal at an index of the input. `on_reduce` holds one callback per rule
+// of Grammar::production_list, which makes the value of the left side from
+// those of the right side; they sit on the value stack and may be moved out.
+// A rule without a callback passes on the value of its first symbol, or a
+// default Value when its right side is empty, so unit rules need none.
+template <typename Value>
+struct SemanticActions {
+  using OnShift = std::function<Value(usize input_idx)>;
+  using OnReduce = std::function<Value(std::span<Value> rhs)>;
+
+  OnShift on_shift{};
+  std::vector<OnReduce> on_reduce{};
+};
+
+// Integer arithmetic over whatever `lexer` last lexed with
+// Lexer::lex_terminals(), so that one set of actions serves every input the
+// lexer is given: numbers, binary + - * / and parentheses, which is all the
+// lexer knows, recognized from the shape of each production. Numbers come
+// from Lexer::values(), parsed while lexing, and the source is only read
+// again to report one that is out of range. Throws for a production it gives
+// no meaning to, and while evaluating on overflow or division by zero.
+// `lexer` must outlive the actions.
+[[nodiscard]] SemanticActions<i64>
+arithmetic_actions(const Grammar &grammar, const Lexer &lexer);
+
+} // namespace epr
+
+#endif // !EPR_PARSER_SEMANTIC_ACTIONS_H
@@ -0,0 +1,476 @@
+#pragma once
+
+#ifndef EPR_PARSER_STATIC_TABLE_H
+#  define EPR_PARSER_STATIC_TABLE_H
+
+#  include "parser/parsing_table.h"
+#  include "util/all.h"
+
+#  include <algorithm>
+#  include <array>
+#  include <ranges>
+#  include <stdexcept>
+#  include <string>
+#  include <string_view>
+#  include <vector>
+
+namespace epr {
+
+// Canonical LR(1) construction with constexpr containers only, so that it can
+// run at compile time. It reads the same grammar format as Grammar::from_str
+// and numbers symbols, rules and states the way the runtime construction
+// does, so a table built here matches ParsingTable cell for cell. Errors are
+// thrown, which turns into a compile error in a constant expression.
+namespace static_lr1 {
+
+struct Rule {
+  u32 lhs{};
+  std::vector<u32> rhs{};
+  Precedence precedence{};
+
+  // By production only, so that a rule's precedence does not tell it apart.
+  constexpr bool operator==(const Rule &other) const {
+    return lhs == other.lhs && rhs == other.rhs;
+  }
+
+  constexpr auto operator<=>(const Rule &other) const {
+    if (const auto order = lhs <=> other.lhs; order != 0)
+      return order;
+    return rhs <=> other.rhs;
+  }
+};
+
+struct Item {
+  u32 rule{};
+  u32 dot{};
+  u32 lookahead{};
+
+  constexpr auto operator<=>(const Item &) const = default;
+};
+
+struct StaticGrammar {
+  std::vector<std::string> names{}; // by id, as in SymbolTable
+  u32 terminal_count{};
+  u32 start_symbol{}; // the augmented one
+  std::vector<Rule> rules{};
+  std::vector<std::pair<std::string, Precedence>> precedence{};
+
+  [[nodiscard]] constexpr u32 symbol_count() const {
+    return static_cast<u32>(names.size());
+  }
+
+  [[nodiscard]] constexpr bool is_terminal(const u32 id) const {
+    return id < terminal_count;
+  }
+
+  [[nodiscard]] constexpr u32 find(const std::string_view name) const {
+    for (u32 id = 0; id < names.size(); ++id)
+      if (names[id] == name)
+        return id;
+    throw std::logic_error("Unknown symbol");
+  }
+
+  [[nodiscard]] constexpr Precedence
+  precedence_of(const std::string_view name) const {
+    for (const auto &[declared_name, declared] : precedence)
+      if (declared_name == name)
+        return declared;
+    return {};
+  }
+
+  // As in Grammar, a name declared again keeps only its last declaration.
+  constexpr void declare(const std::string &name, const Precedence declared) {
+    for (auto &[declared_name, old] : precedence)
+      if (declared_name == name) {
+        old = declared;
+        return;
+      }
+    precedence.emplace_back(name, declared);
+  }
+};
+
+constexpr void sort_unique(std::vector<std::string> &names) {
+  std::ranges::sort(names);
+  names.erase(std::ranges::unique(names).begin(), names.end());
+}
+
+[[nodiscard]] constexpr StaticGrammar
+parse_grammar(const std::string_view text) {
+  const auto lines = split(std::string(text), '\n');
+  if (lines.empty())
+    throw std::logic_error("Empty grammar string");
+
+  struct RawRhs {
+    std::vector<std::string> names{};
+    std::string precedence_tag{};
+  };
+  std::vector<std::pair<std::string, std::vector<RawRhs>>> raw_productions{};
+  std::vector<std::string> terminal_names{};
+  std::vector<std::string> nonterminal_names{lines.front()};
+  StaticGrammar grammar{};
+  u32 level = 0;
+  for (usize idx = 1; idx < lines.size(); ++idx) {
+    if (lines[idx].starts_with('%')) {
+      const auto words = split(lines[idx], ' ');
+      const auto associativity = declared_associativity(words[0]);
+      if (associativity == Associativity::None)
+        throw std::logic_error("Unknown declaration");
+      ++level;
+      for (usize word = 1; word < words.size(); ++word)
+        grammar.declare(words[word], {level, associativity});
+      continue;
+    }
+
+    const auto vec = split(lines[idx], " -> ");
+    if (vec.size() != 2 || !is_nonterminal_name(vec[0]))
+      throw std::logic_error("Malformed production");
+    nonterminal_names.push_back(vec[0]);
+    auto &[lhs, rhs_vec] =
+        raw_productions.emplace_back(vec[0], std::vector<RawRhs>{});
+    for (const auto &rhs : split(vec[1], " | ")) {
+      auto &raw_rhs = rhs_vec.emplace_back();
+      const auto words = split(rhs, ' ');
+      for (usize word = 0; word < words.size(); ++word) {
+        const auto &name = words[word];
+        if (name == "ε")
+          continue;
+        if (name == "%prec") {
+          if (word + 2 != words.size() ||
+              grammar.precedence_of(words[word + 1]).level == 0)
+            throw std::logic_error("Malformed %prec");
+          raw_rhs.precedence_tag = words[++word];
+          continue;
+        }
+        raw_rhs.names.push_back(name);
+        (is_nonterminal_name(name) ? nonterminal_names : terminal_names)
+            .push_back(name);
+      }
+    }
+  }
+  sort_unique(terminal_names);
+  sort_unique(nonterminal_names);
+
+  grammar.names = {"", "$"};
+  grammar.names.insert(
+      grammar.names.end(), terminal_names.begin(), terminal_names.end()
+  );
+  grammar.terminal_count = grammar.symbol_count();
+  grammar.names.insert(
+      grammar.names.end(), nonterminal_names.begin(), nonterminal_names.end()
+  );
+
+  auto start_name = lines.front() + '\'';
+  while (std::ranges::find(grammar.names, start_name) != grammar.names.end())
+    start_name.push_back('\'');
+  grammar.start_symbol = grammar.symbol_count();
+  grammar.names.push_back(start_name);
+
+  for (const auto &[lhs, rhs_vec] : raw_productions)
+    for (const auto &[names, precedence_tag] : rhs_vec) {
+      Rule rule{};
+      rule.lhs = grammar.find(lhs);
+      for (const auto &name : names)
+        rule.rhs.push_back(grammar.find(name));
+      // A repeated production is one rule, as in Grammar, which keeps the
+      // last %prec given to it.
+      if (const auto it = std::ranges::find(grammar.rules, rule);
+          it != grammar.rules.end()) {
+        if (!precedence_tag.empty())
+          it->precedence = grammar.precedence_of(precedence_tag);
+        continue;
+      }
+      // As in yacc: an explicit %prec, else that of the last terminal.
+      if (!precedence_tag.empty())
+        rule.precedence = grammar.precedence_of(precedence_tag);
+      else
+        for (const auto &name : names | std::views::reverse)
+          if (!is_nonterminal_name(name)) {
+            rule.precedence = grammar.precedence_of(name);
+            break;
+          }
+      grammar.rules.push_back(std::move(rule));
+    }
+  grammar.rules.push_back(
+      {grammar.start_symbol, {grammar.find(lines.front())}}
+  );
+  std::ranges::sort(grammar.rules);
+  grammar.rules.erase(
+      std::ranges::unique(grammar.rules).begin(), grammar.rules.end()
+  );
+  for (u32 id = grammar.terminal_count; id < grammar.start_symbol; ++id)
+    if (std::ranges::find(grammar.rules, id, &Rule::lhs) == grammar.rules.end())
+      throw std::logic_error("Non-terminal without productions");
+  return grammar;
+}
+
+struct Automaton {
+  u32 state_count{};
+  std::vector<PackedAction> cells{}; // state_count × symbol_count
+  std::vector<PackedAction> default_reductions{}; // as in ParsingTable
+};
+
+// One flag per terminal id. Plain bytes, since std::vector<bool> costs many
+// more operations under constant evaluation.
+using TerminalFlags = std::vector<u8>;
+
+constexpr bool unite(TerminalFlags &to, const TerminalFlags &from) {
+  bool changed = false;
+  for (usize id = 0; id < to.size(); ++id)
+    if (from[id] && !to[id])
+      to[id] = changed = true;
+  return changed;
+}
+
+[[nodiscard]] constexpr Automaton build(const StaticGrammar &grammar) {
+  const auto symbol_count = grammar.symbol_count();
+  const auto terminal_count = grammar.terminal_count;
+  const auto rule_count = grammar.rules.size();
+
+  // Nullable and FIRST by fixed-point iteration over the rules.
+  std::vector<u8> nullable(symbol_count);
+  std::vector<TerminalFlags> first(
+      symbol_count, TerminalFlags(terminal_count)
+  );
+  for (u32 id = 1; id < terminal_count; ++id)
+    first[id][id] = true;
+  // Adds FIRST(rhs[from..]) to `out` and tells whether that suffix is
+  // nullable.
+  const auto first_of = [&](const std::vector<u32> &rhs, const usize from,
+                            TerminalFlags &out) {
+    for (auto pos = from; pos < rhs.size(); ++pos) {
+      unite(out, first[rhs[pos]]);
+      if (!nullable[rhs[pos]])
+        return false;
+    }
+    return true;
+  };
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (const auto &[lhs, rhs, _] : grammar.rules) {
+      auto &lhs_first = first[lhs];
+      const auto old = lhs_first;
+      if (first_of(rhs, 0, lhs_first) && !nullable[lhs])
+        nullable[lhs] = changed = true;
+      changed = changed || lhs_first != old;
+    }
+  }
+
+  // Closure works per non-terminal rather than per item. Each non-terminal
+  // B collects every lookahead it is reached with, and each rule of B is then
+  // added once per lookahead. A rule B -> C β passes FIRST(β) on to C, and
+  // also the lookaheads of B when β is nullable.
+  std::vector<std::vector<u32>> rules_of(symbol_count);
+  std::vector<TerminalFlags> first_after_head(
+      rule_count, TerminalFlags(terminal_count)
+  );
+  std::vector<u8> nullable_after_head(rule_count);
+  for (u32 rule = 0; rule < rule_count; ++rule) {
+    const auto &[lhs, rhs, _] = grammar.rules[rule];
+    rules_of[lhs].push_back(rule);
+    if (!rhs.empty())
+      nullable_after_head[rule] = first_of(rhs, 1, first_after_head[rule]);
+  }
+
+  const auto closure = [&](const std::vector<Item> &kernel) {
+    std::vector<TerminalFlags> lookaheads(symbol_count);
+    std::vector<u32> worklist{};
+    const auto reach = [&](const u32 nonterminal, const TerminalFlags &flags) {
+      auto &to = lookaheads[nonterminal];
+      if (to.empty())
+        to.assign(terminal_count, false);
+      if (unite(to, flags))
+        worklist.push_back(nonterminal);
+    };
+
+    TerminalFlags flags(terminal_count);
+    for (const auto &[rule, dot, lookahead] : kernel) {
+      const auto &rhs = grammar.rules[rule].rhs;
+      if (dot == rhs.size() || grammar.is_terminal(rhs[dot]))
+        continue;
+      flags.assign(terminal_count, false);
+      if (first_of(rhs, dot + 1, flags))
+        flags[lookahead] = true;
+      reach(rhs[dot], flags);
+    }
+    while (!worklist.empty()) {
+      const auto nonterminal = worklist.back();
+      worklist.pop_back();
+      for (const auto rule : rules_of[nonterminal]) {
+        const auto &rhs = grammar.rules[rule].rhs;
+        if (rhs.empty() || grammar.is_terminal(rhs[0]))
+          continue;
+        flags = first_after_head[rule];
+        if (nullable_after_head[rule])
+          unite(flags, lookaheads[nonterminal]);
+        reach(rhs[0], flags);
+      }
+    }
+
+    auto items = kernel;
+    for (u32 symbol = terminal_count; symbol < symbol_count; ++symbol)
+      if (!lookaheads[symbol].empty())
+        for (const auto rule : rules_of[symbol])
+          for (u32 id = 0; id < terminal_count; ++id)
+            if (lookaheads[symbol][id])
+              items.push_back({rule, 0, id});
+    return items;
+  };
+
+  // Breadth-first from the start kernel, successors in symbol order, states
+  // identified by their sorted kernels.
+  const auto start_rule = static_cast<u32>(
+      std::ranges::find(grammar.rules, grammar.start_symbol, &Rule::lhs) -
+      grammar.rules.begin()
+  );
+  std::vector<std::vector<Item>> kernels{{{start_rule, 0, 1}}};
+  Automaton automaton{};
+  for (usize state = 0; state < kernels.size(); ++state) {
+    const auto items = closure(kernels[state]);
+    automaton.cells.resize((state + 1) * symbol_count);
+    const auto row = automaton.cells.begin() + state * symbol_count;
+
+    std::vector<std::vector<Item>> successors(symbol_count);
+    for (const auto &[rule, dot, lookahead] : items) {
+      const auto &rhs = grammar.rules[rule].rhs;
+      if (dot < rhs.size())
+        successors[rhs[dot]].push_back({rule, dot + 1, lookahead});
+    }
+    for (u32 symbol = 1; symbol < symbol_count; ++symbol) {
+      auto &kernel = successors[symbol];
+      if (kernel.empty())
+        continue;
+      std::ranges::sort(kernel);
+      auto target = static_cast<u32>(
+          std::ranges::find(kernels, kernel) - kernels.begin()
+      );
+      if (target == kernels.size())
+        kernels.push_back(std::move(kernel));
+      row[symbol] = grammar.is_terminal(symbol)
+                        ? PackedAction(PackedAction::Kind::Shift, target)
+                        : PackedAction(PackedAction::Kind::Goto, target);
+    }
+
+    // A shift/reduce conflict may be settled by precedence, exactly as
+    // ParsingTable does; any other conflict is an error.
+    std::vector<bool> completed(terminal_count);
+    bool vetoed = false;
+    for (const auto &[rule, dot, lookahead] : items) {
+      if (dot != grammar.rules[rule].rhs.size())
+        continue;
+      const auto action = rule == start_rule
+                              ? PackedAction(PackedAction::Kind::Accept, 0)
+                              : PackedAction(PackedAction::Kind::Reduce, rule);
+      auto &cell = row[lookahead];
+      if (completed[lookahead])
+        throw std::logic_error("Reduce/reduce conflict");
+      completed[lookahead] = true;
+      if (cell.is_error()) {
+        cell = action;
+        continue;
+      }
+      const auto resolution = resolve_by_precedence(
+          grammar.rules[rule].precedence,
+          grammar.precedence_of(grammar.names[lookahead])
+      );
+      if (!resolution)
+        throw std::logic_error("Shift/reduce conflict");
+      if (*resolution == PackedAction::Kind::Reduce)
+        cell = action;
+      else if (*resolution == PackedAction::Kind::Error) {
+        cell = PackedAction::precedence_error();
+        vetoed = true;
+      }
+    }
+    automaton.default_reductions.push_back(
+        vetoed ? PackedAction{}
+               : find_default_reduction(
+                     std::span(row + 1, row + terminal_count)
+                 )
+    );
+  }
+  automaton.state_count = static_cast<u32>(kernels.size());
+  return automaton;
+}
+
+// A built table in storage of a fixed size, so that a single constant
+// evaluation can hand both the table and its sizes to make_static_table().
+// `words` holds the cells, the default reductions, the left-hand sides and
+// the lengths of the rules, in that order.
+template <usize Capacity>
+struct FlatTable {
+  u32 symbol_count{};
+  u32 terminal_count{};
+  u32 state_count{};
+  u32 rule_count{};
+  std::array<u32, Capacity> words{};
+};
+
+template <usize Capacity>
+[[nodiscard]] constexpr FlatTable<Capacity>
+build_flat(const std::string_view text) {
+  const auto grammar = parse_grammar(text);
+  const auto automaton = build(grammar);
+  FlatTable<Capacity> ret{
+      grammar.symbol_count(), grammar.terminal_count, automaton.state_count,
+      static_cast<u32>(grammar.rules.size())
+  };
+  if (automaton.cells.size() + automaton.default_reductions.size() +
+          2 * grammar.rules.size() >
+      Capacity)
+    throw std::logic_error("Table larger than the capacity given");
+  auto out = ret.words.begin();
+  for (const auto action : automaton.cells)
+    *out++ = action.bits;
+  for (const auto action : automaton.default_reductions)
+    *out++ = action.bits;
+  for (const auto &rule : grammar.rules)
+    *out++ = rule.lhs;
+  for (const auto &rule : grammar.rules)
+    *out++ = static_cast<u32>(rule.rhs.size());
+  return ret;
+}
+
+} // namespace static_lr1
+
+// A parsing table built at compile time by make_static_table().
+template <u32 Symbols, u32 States, u32 Rules>
+struct StaticTable {
+  u32 terminal_count{};
+  std::array<PackedAction, usize{States} * Symbols> cells{};
+  std::array<PackedAction, States> default_reductions{};
+  std::array<u32, Rules> rule_lhs{};
+  std::array<u32, Rules> rule_length{};
+
+  [[nodiscard]] constexpr PackedAction
+  lookup(const usize state, const u32 col) const {
+    return cells[state * Symbols + col];
+  }
+
+  [[nodiscard]] constexpr TableView view() const {
+    return {States, Symbols, terminal_count, cells, default_reductions};
+  }
+};
+
+// The canonical LR(1) table of the grammar in `Text`, built entirely during
+// compilation. A malformed grammar, a conflict, or a table of more than
+// `Capacity` words (cells, default reductions and two per rule) fails the
+// build.
+template <const std::string_view &Text, usize Capacity = usize{1} << 14>
+consteval auto make_static_table() {
+  constexpr auto flat = static_lr1::build_flat<Capacity>(Text);
+
+  StaticTable<flat.symbol_count, flat.state_count, flat.rule_count> ret{};
+  ret.terminal_count = flat.terminal_count;
+  auto in = flat.words.begin();
+  for (auto &cell : ret.cells)
+    cell.bits = *in++;
+  for (auto &action : ret.default_reductions)
+    action.bits = *in++;
+  in = std::ranges::copy_n(in, flat.rule_count, ret.rule_lhs.begin()).in;
+  std::ranges::copy_n(in, flat.rule_count, ret.rule_length.begin());
+  return ret;
+}
+
+} // namespace epr
+
+#endif // !EPR_PARSER_STATIC_TABLE_H
@@ -3,38 +3,85 @@
 #include "util/all.h"
 
 #include <format>
+#include <stdexcept>
 #include <vector>
 
 namespace epr {
 
-Symbol::Symbol(std::string v, const Type type):
-    name(std::move(v)), type(type) {}
+std::string Symbol::to_string(const SymbolTable &symbols) const {
+  const auto &name = symbols.name(*this);
+  if (name.empty())
+    return "~";
+  return name;
+}
 
-bool Symbol::operator<(const Symbol &rhs) const {
-  return name < rhs.name;
+SymbolTable::SymbolTable() {
+  intern("", Symbol::Terminator);
+  intern("$", Symbol::Terminator);
 }
 
-bool Symbol::operator==(const Symbol &rhs) const {
-  return name == rhs.name;
+Symbol SymbolTable::intern(const std::string &name, const Symbol::Type type) {
+  if (const auto it = ids_.find(name); it != ids_.end()) {
+    if (at(it->second).type != type)
+      throw std::logic_error(
+          std::format("Symbol '{}' used as both kinds of symbol", name)
+      );
+    return at(it->second);
+  }
+  if (type == Symbol::Terminator && nonterminal_count() != 0)
+    throw std::logic_error(
+        std::format("Terminal '{}' interned after non-terminals", name)
+    );
+
+  const auto id = static_cast<u32>(names_.size());
+  names_.push_back(name);
+  ids_.emplace(name, id);
+  if (type == Symbol::Terminator)
+    ++terminal_count_;
+  return {id, type};
 }
 
-Symbol Symbol::empty_symbol() {
-  return {"", Symbol::Terminator};
+std::optional<Symbol> SymbolTable::find(const std::string &name) const {
+  const auto it = ids_.find(name);
+  if (it == ids_.end())
+    return std::nullopt;
+  return at(it->second);
 }
 
-std::string Symbol::to_string() const {
-  if (name.empty())
-    return "~";
-  return name;
+Symbol SymbolTable::at(const u32 id) const {
+  return {
+      id, id < terminal_count_ ? Symbol::Terminator : Symbol::NonTerminator
+  };
+}
+
+const std::string &SymbolTable::name(const Symbol &symbol) const {
+  return names_.at(symbol.id);
+}
+
+u32 SymbolTable::size() const {
+  return static_cast<u32>(names_.size());
+}
+
+u32 SymbolTable::terminal_count() const {
+  return terminal_count_;
+}
+
+u32 SymbolTable::nonterminal_count() const {
+  return size() - terminal_count_;
 }
 
-[[nodiscard]] std::string
-to_string(const std::pair<const Symbol, std::vector<Symbol>> &production) {
+[[nodiscard]] std::string to_string(
+    const std::pair<const Symbol, std::vector<Symbol>> &production,
+    const SymbolTable &symbols
+) {
   const auto &[lhs, rhs] = production;
-  std::string buf = std::format("{} -> ", lhs.to_string());
+  std::string buf = std::format("{} -> ", lhs.to_string(symbols));
   for (const auto &symbol : rhs)
-    buf.append(symbol.to_string()).append(1, ' ');
-  buf.pop_back();
+    buf.append(symbol.to_string(symbols)).append(1, ' ');
+  if (rhs.empty())
+    buf.append("ε");
+  else
+    buf.pop_back();
   return buf;
 }
 
@@ -5,37 +5,75 @@
 
 #  include "util/all.h"
 
+#  include <optional>
 #  include <string>
+#  include <string_view>
+#  include <unordered_map>
 #  include <vector>
 
 namespace epr {
 
+class SymbolTable;
+
 struct Symbol {
-  std::string name{};
+  u32 id{};
+
+  enum Type : u8 { Terminator, NonTerminator } type{Terminator};
+
+  constexpr Symbol() = default;
+
+  constexpr Symbol(const u32 id, const Type type): id(id), type(type) {}
+
+  constexpr bool operator<(const Symbol &rhs) const {
+    return id < rhs.id;
+  }
 
-  enum Type { Terminator, NonTerminator } type;
+  constexpr bool operator==(const Symbol &rhs) const {
+    return id == rhs.id;
+  }
+
+  static constexpr Symbol empty_symbol() {
+    return {0, Terminator};
+  }
+
+  static constexpr Symbol end_symbol() {
+    return {1, Terminator};
+  }
+
+  [[nodiscard]] std::string to_string(const SymbolTable &symbols) const;
+};
 
-  Symbol(const Symbol &rhs) = default;
+// Interns symbol names into dense ids. Terminals occupy [0, terminal_count())
+// and non-terminals [terminal_count(), size()), so an id doubles as a table
+// column and as a bit index into terminal sets. Id 0 is the empty symbol and
+// id 1 is the end marker `$`.
+class SymbolTable {
+  std::vector<std::string> names_{};
+  std::unordered_map<std::string, u32> ids_{};
+  u32 terminal_count_{};
 
-  Symbol(Symbol &&rhs) noexcept = default;
+public:
+  SymbolTable();
 
-  Symbol &operator=(const Symbol &rhs) = default;
+  Symbol intern(const std::string &name, Symbol::Type type);
 
-  Symbol &operator=(Symbol &&rhs) noexcept = default;
+  [[nodiscard]] std::optional<Symbol> find(const std::string &name) const;
 
-  Symbol(std::string v, Type type);
+  [[nodiscard]] Symbol at(u32 id) const;
 
-  bool operator<(const Symbol &rhs) const;
+  [[nodiscard]] const std::string &name(const Symbol &symbol) const;
 
-  bool operator==(const Symbol &rhs) const;
+  [[nodiscard]] u32 size() const;
 
-  static Symbol empty_symbol();
+  [[nodiscard]] u32 terminal_count() const;
 
-  [[nodiscard]] std::string to_string() const;
+  [[nodiscard]] u32 nonterminal_count() const;
 };
 
-[[nodiscard]] std::string
-to_string(const std::pair<const Symbol, std::vector<Symbol>> &production);
+[[nodiscard]] std::string to_string(
+    const std::pair<const Symbol, std::vector<Symbol>> &production,
+    const SymbolTable &symbols
+);
 
 } // namespace epr
 
@@ -0,0 +1,253 @@
+#include "parser/table_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace epr {
+
+namespace {
+
+template <typename T>
+void write_array(std::ofstream &out, const std::span<const T> array) {
+  out.write(
+      reinterpret_cast<const char *>(array.data()),
+      static_cast<std::streamsize>(array.size_bytes())
+  );
+}
+
+} // namespace
+
+void write_table_file(
+    const std::filesystem::path &path, const u64 key, const Grammar &grammar,
+    const TableView &table
+) {
+  const auto &symbols = grammar.symbols;
+  std::vector<u32> name_offsets{0};
+  std::string names{};
+  for (u32 id = 0; id < symbols.size(); ++id) {
+    names.append(symbols.name(symbols.at(id)));
+    name_offsets.push_back(static_cast<u32>(names.size()));
+  }
+
+  std::vector<u32> rule_lhs{};
+  std::vector<u32> rhs_offsets{0};
+  std::vector<u32> rhs_symbols{};
+  for (const auto &[lhs, rhs] : grammar.production_list) {
+    rule_lhs.push_back(lhs.id);
+    for (const auto &symbol : rhs)
+      rhs_symbols.push_back(symbol.id);
+    rhs_offsets.push_back(static_cast<u32>(rhs_symbols.size()));
+  }
+
+  TableFileHeader header{};
+  std::memcpy(header.magic, TableFileHeader::MAGIC, sizeof(header.magic));
+  header.version = TableFileHeader::VERSION;
+  header.endian_mark = TableFileHeader::ENDIAN_MARK;
+  header.symbol_count = symbols.size();
+  header.key = key;
+  header.terminal_count = symbols.terminal_count();
+  header.start_symbol = grammar.start_symbol.id;
+  header.rule_count = static_cast<u32>(rule_lhs.size());
+  header.rhs_count = static_cast<u32>(rhs_symbols.size());
+  header.rows = table.rows;
+  header.cols = table.cols;
+  header.name_bytes = static_cast<u32>(names.size());
+
+  // Written beside the target and renamed over it, so that a reader never
+  // maps a half-written file.
+  auto temp_path = path;
+  temp_path += std::format(".{}.tmp", getpid());
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out)
+      throw std::runtime_error(
+          std::format("Cannot write table file '{}'", temp_path.string())
+      );
+    write_array(out, std::span<const TableFileHeader>(&header, 1));
+    write_array<u32>(out, name_offsets);
+    write_array<u32>(out, rule_lhs);
+    write_array<u32>(out, rhs_offsets);
+    write_array<u32>(out, rhs_symbols);
+    write_array(out, table.cells);
+    if (table.default_reductions.empty())
+      write_array<PackedAction>(out, std::vector<PackedAction>(table.rows));
+    else
+      write_array(out, table.default_reductions);
+    write_array<char>(out, names);
+    if (!out.flush())
+      throw std::runtime_error(
+          std::format("Cannot write table file '{}'", temp_path.string())
+      );
+  }
+  std::filesystem::rename(temp_path, path);
+}
+
+void MappedTable::Unmap::operator()(const std::byte *data) const {
+  ::munmap(const_cast<std::byte *>(data), size);
+}
+
+MappedTable::MappedTable(const std::filesystem::path &path, const u64 key) {
+  const auto fail = [&](const std::string_view reason) {
+    return std::runtime_error(
+        std::format("Bad table file '{}': {}", path.string(), reason)
+    );
+  };
+
+  const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    throw fail("cannot open");
+  struct stat st{};
+  if (::fstat(fd, &st) != 0 ||
+      static_cast<usize>(st.st_size) < sizeof(TableFileHeader)) {
+    ::close(fd);
+    throw fail("truncated header");
+  }
+  const auto size = static_cast<usize>(st.st_size);
+  auto *const data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED)
+    throw fail("cannot map");
+  data_ = {static_cast<const std::byte *>(data), Unmap{size}};
+
+  std::memcpy(&header_, data_.get(), sizeof(header_));
+  if (std::memcmp(header_.magic, TableFileHeader::MAGIC, 4) != 0)
+    throw fail("not a table file");
+  if (header_.version != TableFileHeader::VERSION)
+    throw fail(std::format("version {}", header_.version));
+  if (header_.endian_mark != TableFileHeader::ENDIAN_MARK)
+    throw fail("foreign byte order");
+  if (header_.key != key)
+    throw fail("built from a different grammar");
+
+  const usize words = (header_.symbol_count + 1ull) + header_.rule_count +
+                      (header_.rule_count + 1ull) + header_.rhs_count +
+                      static_cast<usize>(header_.rows) * header_.cols +
+                      header_.rows;
+  if (size != sizeof(header_) + words * sizeof(u32) + header_.name_bytes)
+    throw fail("size does not match header");
+
+  const auto *cursor =
+      reinterpret_cast<const u32 *>(data_.get() + sizeof(TableFileHeader));
+  const auto take = [&](const usize count) {
+    const auto ret = std::span(cursor, count);
+    cursor += count;
+    return ret;
+  };
+  name_offsets_ = take(header_.symbol_count + 1);
+  rule_lhs_ = take(header_.rule_count);
+  rhs_offsets_ = take(header_.rule_count + 1);
+  rhs_symbols_ = take(header_.rhs_count);
+  const auto cells = take(static_cast<usize>(header_.rows) * header_.cols);
+  cells_ = {reinterpret_cast<const PackedAction *>(cells.data()), cells.size()};
+  const auto defaults = take(header_.rows);
+  default_reductions_ = {
+      reinterpret_cast<const PackedAction *>(defaults.data()), defaults.size()
+  };
+  names_ = reinterpret_cast<const char *>(cursor);
+
+  // Everything a parse indexes with is checked here, so that a damaged or
+  // forged file is rebuilt instead of read out of bounds.
+  const auto is_symbol = [&](const u32 id) {
+    return id < header_.symbol_count;
+  };
+  const auto is_nonterminal = [&](const u32 id) {
+    return id >= header_.terminal_count && is_symbol(id);
+  };
+  if (header_.rows == 0 || header_.cols != header_.symbol_count ||
+      header_.terminal_count > header_.symbol_count ||
+      !is_nonterminal(header_.start_symbol))
+    throw fail("inconsistent counts");
+  if (!std::ranges::is_sorted(name_offsets_) ||
+      name_offsets_.back() != header_.name_bytes ||
+      !std::ranges::is_sorted(rhs_offsets_) ||
+      rhs_offsets_.back() != header_.rhs_count)
+    throw fail("inconsistent offsets");
+  if (!std::ranges::all_of(rule_lhs_, is_nonterminal) ||
+      !std::ranges::all_of(rhs_symbols_, is_symbol))
+    throw fail("symbol out of range");
+
+  // Shifts, reductions and accepts sit in terminal columns and gotos in the
+  // others; states and rules must exist. An error cell is 0 or a %nonassoc
+  // veto.
+  const auto is_cell = [&](const PackedAction action, const u32 col) {
+    const bool terminal = col < header_.terminal_count;
+    switch (action.kind()) {
+      case PackedAction::Kind::Error:
+        return action.value() <= PackedAction::precedence_error().value();
+      case PackedAction::Kind::Shift:
+        return terminal && action.value() < header_.rows;
+      case PackedAction::Kind::Goto:
+        return !terminal && action.value() < header_.rows;
+      case PackedAction::Kind::Reduce:
+        return terminal && action.value() < header_.rule_count;
+      case PackedAction::Kind::Accept:
+        return terminal;
+      default:
+        return false;
+    }
+  };
+  for (usize idx = 0; idx < cells_.size(); ++idx)
+    if (!is_cell(cells_[idx], static_cast<u32>(idx % header_.cols)))
+      throw fail(std::format("bad cell {}", idx));
+  for (const auto action : default_reductions_)
+    if (action != PackedAction{} &&
+        (action.kind() != PackedAction::Kind::Reduce ||
+         action.value() >= header_.rule_count))
+      throw fail("bad default reduction");
+}
+
+TableView MappedTable::table() const {
+  return {
+      header_.rows, header_.cols, header_.terminal_count, cells_,
+      default_reductions_
+  };
+}
+
+Grammar MappedTable::grammar() const {
+  const auto name = [&](const u32 id) {
+    return std::string(
+        names_ + name_offsets_[id], name_offsets_[id + 1] - name_offsets_[id]
+    );
+  };
+
+  // Ids 0 and 1 are the empty symbol and the end marker, which every
+  // SymbolTable starts with.
+  SymbolTable symbols{};
+  for (u32 id = symbols.size(); id < header_.symbol_count; ++id)
+    symbols.intern(
+        name(id),
+        id < header_.terminal_count ? Symbol::Terminator : Symbol::NonTerminator
+    );
+
+  Grammar grammar(symbols.at(header_.start_symbol));
+  grammar.productions_of.assign(symbols.size(), {});
+  for (u32 rule = 0; rule < header_.rule_count; ++rule) {
+    const auto lhs = symbols.at(rule_lhs_[rule]);
+    std::vector<Symbol> rhs{};
+    for (auto idx = rhs_offsets_[rule]; idx < rhs_offsets_[rule + 1]; ++idx)
+      rhs.push_back(symbols.at(rhs_symbols_[idx]));
+    grammar.push_production(lhs, rhs);
+    grammar.production_index[{lhs, rhs}] = rule;
+    grammar.productions_of[lhs.id].push_back(rule);
+    grammar.production_list.emplace_back(lhs, std::move(rhs));
+  }
+  grammar.symbols = std::move(symbols);
+  return grammar;
+}
+
+std::filesystem::path
+table_cache_path(const std::filesystem::path &dir, const u64 key) {
+  return dir / std::format("{:016x}.eprt", key);
+}
+
+} // namespace epr
@@ -0,0 +1,96 @@
+#pragma once
+
+#ifndef EPR_PARSER_TABLE_FILE_H
+#  define EPR_PARSER_TABLE_FILE_H
+
+#  include "parser/grammar.h"
+#  include "parser/parsing_table.h"
+#  include "util/all.h"
+
+#  include <filesystem>
+#  include <memory>
+#  include <span>
+
+namespace epr {
+
+// A built parsing table and the productions it reduces by, in a form that is
+// used in place once mapped. The layout is a TableFileHeader followed by u32
+// arrays and then the symbol names:
+//
+//   name_offsets[symbol_count + 1]  rule_lhs[rule_count]
+//   rhs_offsets[rule_count + 1]     rhs_symbols[rhs_count]
+//   cells[rows * cols]              default_reductions[rows]
+//   names[name_bytes]
+//
+// Integers are in host byte order; `endian_mark` rejects a file from a host
+// of the other order.
+struct TableFileHeader {
+  static constexpr char MAGIC[4] = {'E', 'P', 'R', 'T'};
+  static constexpr u32 VERSION = 3;
+  static constexpr u32 ENDIAN_MARK = 0x0102'0304;
+
+  char magic[4]{};
+  u32 version{};
+  u32 endian_mark{};
+  u32 symbol_count{};
+  u64 key{};
+  u32 terminal_count{};
+  u32 start_symbol{};
+  u32 rule_count{};
+  u32 rhs_count{};
+  u32 rows{};
+  u32 cols{};
+  u32 name_bytes{};
+  u32 reserved{};
+};
+
+void write_table_file(
+    const std::filesystem::path &path, u64 key, const Grammar &grammar,
+    const TableView &table
+);
+
+// Read-only mapping of a table file. Opening checks the header against `key`,
+// the file size against the counts in it, and every symbol, rule and state
+// that the arrays refer to, and throws on any mismatch.
+class MappedTable {
+  struct Unmap {
+    usize size;
+
+    void operator()(const std::byte *data) const;
+  };
+
+  std::unique_ptr<const std::byte, Unmap> data_;
+  TableFileHeader header_{};
+  std::span<const u32> name_offsets_{};
+  std::span<const u32> rule_lhs_{};
+  std::span<const u32> rhs_offsets_{};
+  std::span<const u32> rhs_symbols_{};
+  std::span<const PackedAction> cells_{};
+  std::span<const PackedAction> default_reductions_{};
+  const char *names_{};
+
+public:
+  MappedTable(const std::filesystem::path &path, u64 key);
+
+  MappedTable(const MappedTable &rhs) = delete;
+
+  MappedTable(MappedTable &&rhs) noexcept = default;
+
+  MappedTable &operator=(const MappedTable &rhs) = delete;
+
+  MappedTable &operator=(MappedTable &&rhs) noexcept = default;
+
+  [[nodiscard]] TableView table() const;
+
+  // Symbols and productions only: enough to drive a parse, not to rebuild
+  // the table.
+  [[nodiscard]] Grammar grammar() const;
+};
+
+// Where a table keyed by `key` lives inside a cache directory.
+[[nodiscard]] std::filesystem::path
+table_cache_path(const std::filesystem::path &dir, u64 key);
+
+} // namespace epr
+
+#endif // !EPR_PARSER_TABLE_FILE_H
@@ -0,0 +1,112 @@
+#pragma once
+
+#ifndef EPR_SIMPLE_LEXER_DIGITS_H
+#  define EPR_SIMPLE_LEXER_DIGITS_H
+
+#  include "util/all.h"
+
+#  include <optional>
+#  include <string_view>
+#  include <vector>
+
+namespace epr {
+
+// The value of eight ASCII digits packed into `chunk`, the first digit in the
+// lowest byte. Adjacent digits are combined in parallel within the word:
+// pairs, then quads, then the two halves, in three multiplications.
+[[nodiscard]] constexpr u32 parse_eight_digits(u64 chunk) {
+  chunk -= 0x3030'3030'3030'3030;
+  chunk = chunk * 10 + (chunk >> 8);
+  constexpr u64 MASK = 0x0000'00FF'0000'00FF;
+  constexpr u64 MUL_HIGH = 100 + (1'000'000ull << 32);
+  constexpr u64 MUL_LOW = 1 + (10'000ull << 32);
+  return static_cast<u32>(
+      ((chunk & MASK) * MUL_HIGH + ((chunk >> 16) & MASK) * MUL_LOW) >> 32
+  );
+}
+
+// The eight-byte chunk of `digits` at `pos` that holds the `step` digits
+// there, padded in front with '0's. Built byte by byte, which compilers fold
+// into a load, so that it also works in constant expressions and on either
+// byte order.
+[[nodiscard]] constexpr u64 digit_chunk(
+    const std::string_view digits, const usize pos, const usize step
+) {
+  constexpr u64 ZEROS = 0x3030'3030'3030'3030;
+  auto chunk = step == 8 ? 0 : ZEROS >> (8 * step);
+  for (usize idx = 0; idx < step; ++idx)
+    chunk |= static_cast<u64>(static_cast<u8>(digits[pos + idx]))
+             << (8 * (8 - step + idx));
+  return chunk;
+}
+
+inline constexpr u64 DIGIT_POWERS[] = {1,         10,         100,
+                                       1'000,     10'000,     100'000,
+                                       1'000'000, 10'000'000, 100'000'000};
+
+// The value of `digits`, all of them '0' to '9', or nothing if it does not
+// fit in 64 bits; leading zeros are fine. Takes eight digits per step, the
+// first step fewer, so that every step is whole.
+[[nodiscard]] constexpr std::optional<u64>
+parse_digits(const std::string_view digits) {
+  u64 value = 0;
+  usize pos = 0;
+  for (auto step = (digits.size() - 1) % 8 + 1; pos < digits.size();
+       pos += step, step = 8)
+    if (__builtin_mul_overflow(value, DIGIT_POWERS[step], &value) ||
+        __builtin_add_overflow(
+            value, parse_eight_digits(digit_chunk(digits, pos, step)), &value
+        ))
+      return std::nullopt;
+  return value;
+}
+
+// The value of `digits` as parse_digits() reads them, but of any width:
+// appended to `limbs` in base 2^64, least significant limb first, with no
+// zero limb on top, so that 0 appends nothing. Each step multiplies the limbs
+// so far by at most 10^8 in 32-bit halves, which keeps every product within
+// 64 bits.
+constexpr void
+parse_wide_digits(const std::string_view digits, std::vector<u64> &limbs) {
+  const auto first = limbs.size();
+  usize pos = 0;
+  for (auto step = (digits.size() - 1) % 8 + 1; pos < digits.size();
+       pos += step, step = 8) {
+    const auto power = DIGIT_POWERS[step];
+    u64 carry = parse_eight_digits(digit_chunk(digits, pos, step));
+    for (auto idx = first; idx < limbs.size(); ++idx) {
+      const auto low = (limbs[idx] & 0xFFFF'FFFF) * power + carry;
+      const auto high = (limbs[idx] >> 32) * power + (low >> 32);
+      limbs[idx] = (high << 32) | (low & 0xFFFF'FFFF);
+      carry = high >> 32;
+    }
+    if (carry != 0)
+      limbs.push_back(carry);
+  }
+}
+
+static_assert(parse_eight_digits(0x3837'3635'3433'3231) == 12'345'678);
+static_assert(parse_digits("0") == 0);
+static_assert(parse_digits("123456789012") == 123'456'789'012);
+static_assert(parse_digits("18446744073709551615") == ~u64{0});
+static_assert(!parse_digits("18446744073709551616"));
+static_assert(parse_digits("000000000000000000000042") == 42);
+static_assert([] {
+  std::vector<u64> limbs{};
+  parse_wide_digits("0000", limbs);
+  return limbs.empty();
+}());
+static_assert([] {
+  std::vector<u64> limbs{7};
+  parse_wide_digits("18446744073709551616", limbs); // 2^64
+  return limbs == std::vector<u64>{7, 0, 1};
+}());
+static_assert([] {
+  std::vector<u64> limbs{};
+  parse_wide_digits("340282366920938463463374607431768211455", limbs);
+  return limbs == std::vector<u64>{~u64{0}, ~u64{0}}; // 2^128 - 1
+}());
+
+} // namespace epr
+
+#endif // !EPR_SIMPLE_LEXER_DIGITS_H
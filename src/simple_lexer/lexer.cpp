@@ -1,90 +1,82 @@
 #include "simple_lexer/lexer.h"
 
-#include <cctype>
-#include <set>
+#include "simple_lexer/digits.h"
+#include "simple_lexer/scanner.h"
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+#include <string_view>
 
 namespace epr {
 
+namespace {
+
+[[nodiscard]] bool is_digit(const char c) {
+  return static_cast<u8>(c - '0') < 10;
+}
+
+} // namespace
+
 Lexer Lexer::with_src(const std::string &src) {
   Lexer lexer{};
   lexer.load_src(src);
   return lexer;
 }
 
-void Lexer::load_src(const std::string &src) {
-  pos_ = 0;
-  src_ = src;
+void Lexer::load_src(const std::string_view src) {
+  src_.assign(src);
 }
 
 void Lexer::load_src(std::string &&src) {
-  pos_ = 0;
   src_ = std::move(src);
 }
 
-TokenStream Lexer::lex_effective() {
-  TokenStream token_stream;
-  for (std::optional<Token> token_opt; (token_opt = next_token());) {
-    std::visit(
-        overloaded{
-            [](const LexError &) {
-              throw std::runtime_error("Lex error");
-            },
-            [](const Whitespace &) {},
-            [&](const auto &token) {
-              token_stream.push_back(token);
-            },
-        },
-        *token_opt
-    );
+const std::vector<u32> &Lexer::lex_terminals(const TerminalMap &map) {
+  const auto error = scan_tokens(src_, spans_);
+  terminals_.clear();
+  values_.clear();
+  wide_tokens_.clear();
+  wide_offsets_.assign(1, 0);
+  wide_limbs_.clear();
+  for (const auto &[begin, end] : spans_) {
+    const auto c = src_[begin];
+    const auto number = is_digit(c);
+    const auto terminal =
+        number ? map.integer : map.punctuator[static_cast<u8>(c)];
+    if (terminal == 0)
+      throw std::runtime_error(std::format(
+          "Unexpected token '{}'", number ? "n" : std::string(1, c)
+      ));
+    terminals_.push_back(terminal);
+    if (!number) {
+      values_.push_back(0);
+      continue;
+    }
+    const auto digits = std::string_view(src_).substr(begin, end - begin);
+    values_.push_back(parse_digits(digits));
+    if (!values_.back() && options_.keep_wide_integers) {
+      wide_tokens_.push_back(values_.size() - 1);
+      parse_wide_digits(digits, wide_limbs_);
+      wide_offsets_.push_back(wide_limbs_.size());
+    }
   }
-  return token_stream;
-}
-
-std::optional<char> Lexer::peek(const usize offset) const {
-  if (pos_ + offset >= src_.size())
-    return std::nullopt;
-  return src_.at(pos_ + offset);
-}
-
-bool Lexer::reached_eof() const {
-  return pos_ >= src_.size();
-}
-
-std::optional<char> Lexer::consume() {
-  if (reached_eof())
-    return std::nullopt;
-  return src_.at(pos_++);
-}
-
-std::optional<Token> Lexer::next_token() {
-  const auto cur_char = consume();
-  if (!cur_char)
-    return std::nullopt;
-
-  if (isspace(*cur_char))
-    return consume_whitespace();
-  if (isdigit(*cur_char))
-    return consume_integer();
-  return punctuator(*cur_char);
-}
-
-Token Lexer::consume_whitespace() {
-  while (peek() && isspace(*peek()))
-    consume();
-  return Whitespace{};
+  if (error < src_.size())
+    throw std::runtime_error("Lex error");
+  return terminals_;
 }
 
-Token Lexer::consume_integer() {
-  while (peek() && isdigit(*peek()))
-    consume();
-  return Integer{};
+const std::vector<SourceSpan> &Lexer::spans() const {
+  return spans_;
 }
 
-Token Lexer::punctuator(const char first_char) {
-  static std::set<char> valid_punctuators{'(', ')', '+', '-', '*', '/'};
-  if (valid_punctuators.contains(first_char))
-    return Punctuator{first_char};
-  return LexError{};
+std::span<const u64> Lexer::wide_value(const usize idx) const {
+  const auto it = std::ranges::lower_bound(wide_tokens_, idx);
+  if (it == wide_tokens_.end() || *it != idx)
+    return {};
+  const auto nth = static_cast<usize>(it - wide_tokens_.begin());
+  return std::span(wide_limbs_)
+      .subspan(wide_offsets_[nth], wide_offsets_[nth + 1] - wide_offsets_[nth]);
 }
 
 } // namespace epr
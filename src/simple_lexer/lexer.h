@@ -6,17 +6,47 @@
 #  include "simple_lexer/token.h"
 #  include "util/all.h"
 
+#  include <array>
 #  include <optional>
+#  include <span>
+#  include <string>
+#  include <string_view>
+#  include <vector>
 
 namespace epr {
 
+// Terminal ids for a lexer that feeds a parser directly: integers, and
+// punctuators by their byte. 0 marks a token the grammar has no terminal
+// for.
+struct TerminalMap {
+  u32 integer{};
+  std::array<u32, 256> punctuator{};
+};
+
+struct LexerOptions {
+  // Also keep the value of every number too wide for 64 bits, for actions
+  // that do arbitrary-width arithmetic; see Lexer::wide_value().
+  bool keep_wide_integers{false};
+};
+
 class Lexer {
-  usize pos_{};
+  LexerOptions options_{};
   std::string src_{};
+  std::vector<SourceSpan> spans_{};
+  std::vector<u32> terminals_{};
+  std::vector<std::optional<u64>> values_{};
+  // Numbers too wide for 64 bits, when kept: their token indices in order,
+  // and where each one's limbs start in `wide_limbs_`, with the end of the
+  // last one after them.
+  std::vector<usize> wide_tokens_{};
+  std::vector<usize> wide_offsets_{};
+  std::vector<u64> wide_limbs_{};
 
 public:
   Lexer() = default;
 
+  explicit Lexer(const LexerOptions &options): options_(options) {}
+
   Lexer(const Lexer &rhs) = delete;
 
   Lexer(Lexer &&rhs) noexcept = default;
@@ -27,25 +57,34 @@ public:
 
   static Lexer with_src(const std::string &src);
 
-  void load_src(const std::string &src);
+  void load_src(std::string_view src);
 
   void load_src(std::string &&src);
 
-  std::vector<Token> lex_effective();
-
-  [[nodiscard]] std::optional<Token> next_token();
-
-  [[nodiscard]] bool reached_eof() const;
-
-  [[nodiscard]] std::optional<char> peek(usize offset = 0) const;
-
-  std::optional<char> consume();
-
-  [[nodiscard]] Token consume_whitespace();
-
-  [[nodiscard]] Token consume_integer();
-
-  [[nodiscard]] static Token punctuator(char first_char);
+  // Lexes the whole source straight into terminal ids through `map`, with
+  // no Token in between; the storage is reused by the next call. Throws on a
+  // byte the lexer does not know, or a token `map` has no terminal for.
+  const std::vector<u32> &lex_terminals(const TerminalMap &map);
+
+  // Spans of the tokens of the last lex_terminals().
+  [[nodiscard]] const std::vector<SourceSpan> &spans() const;
+
+  [[nodiscard]] std::string_view source() const {
+    return src_;
+  }
+
+  // By token of the last lex_terminals(): the value of a number, 0 for the
+  // other tokens, or nothing for a number too wide for 64 bits, whose digits
+  // remain in source() at its span.
+  [[nodiscard]] const std::vector<std::optional<u64>> &values() const {
+    return values_;
+  }
+
+  // The value of the number at token `idx` of the last lex_terminals() that
+  // values() has nothing for, parsed as it was lexed when the options keep
+  // wide integers: in base 2^64, least significant limb first. Empty for
+  // any other token.
+  [[nodiscard]] std::span<const u64> wide_value(usize idx) const;
 };
 
 } // namespace epr
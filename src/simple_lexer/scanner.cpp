@@ -0,0 +1,270 @@
+#include "simple_lexer/scanner.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <optional>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  define EPR_SCANNER_X86 1
+#  include <immintrin.h>
+#endif
+
+namespace epr {
+
+namespace {
+
+constexpr usize BLOCK = 64;
+// Blocks classified per call, so that the masks fit on the stack.
+constexpr usize BATCH = 16;
+
+// One bit per byte of a block, the lowest for the first byte. A byte in none
+// of the masks starts no token.
+struct BlockMasks {
+  u64 digit{};
+  u64 punct{};
+  u64 space{};
+};
+
+using Classify = void (*)(const char *src, usize blocks, BlockMasks *out);
+
+enum ByteClass : u8 { DIGIT = 1, PUNCT = 2, SPACE = 4 };
+
+constexpr auto BYTE_CLASS = [] {
+  std::array<u8, 256> ret{};
+  for (auto c = '0'; c <= '9'; ++c)
+    ret[static_cast<u8>(c)] = DIGIT;
+  for (const auto c : std::string_view("()*+-/"))
+    ret[static_cast<u8>(c)] = PUNCT;
+  for (const auto c : std::string_view(" \t\n\v\f\r"))
+    ret[static_cast<u8>(c)] = SPACE;
+  return ret;
+}();
+
+void classify_scalar(const char *src, const usize blocks, BlockMasks *out) {
+  for (usize block = 0; block < blocks; ++block, src += BLOCK) {
+    BlockMasks masks{};
+    for (usize idx = 0; idx < BLOCK; ++idx) {
+      const auto cls = BYTE_CLASS[static_cast<u8>(src[idx])];
+      masks.digit |= static_cast<u64>(cls & DIGIT) << idx;
+      masks.punct |= static_cast<u64>((cls & PUNCT) >> 1) << idx;
+      masks.space |= static_cast<u64>((cls & SPACE) >> 2) << idx;
+    }
+    out[block] = masks;
+  }
+}
+
+#ifdef EPR_SCANNER_X86
+
+// The vector classifiers look a byte up by each of its nibbles and AND the
+// results. Whitespace takes two bits, for the controls 0x09-0x0D and for
+// ' ', which would otherwise match '\0' and 0x29 through the shared nibbles;
+// no byte ends up with more than one bit set.
+//
+//   high nibble   0: TAB_CR   2: PUNCT | BLANK   3: DIGIT   others: none
+//   low nibble    0: DIGIT | BLANK   1-7: DIGIT   8: DIGIT | PUNCT
+//                 9: DIGIT | PUNCT | TAB_CR   A, B, D: PUNCT | TAB_CR
+//                 C: TAB_CR   E: none   F: PUNCT
+enum NibbleClass : char { N_DIGIT = 1, N_PUNCT = 2, N_TAB_CR = 4, N_BLANK = 8 };
+
+#  define EPR_LOW_NIBBLE_CLASSES                                              \
+    N_DIGIT | N_BLANK, N_DIGIT, N_DIGIT, N_DIGIT, N_DIGIT, N_DIGIT, N_DIGIT,  \
+        N_DIGIT, N_DIGIT | N_PUNCT, N_DIGIT | N_PUNCT | N_TAB_CR,             \
+        N_PUNCT | N_TAB_CR, N_PUNCT | N_TAB_CR, N_TAB_CR, N_PUNCT | N_TAB_CR, \
+        0, N_PUNCT
+#  define EPR_HIGH_NIBBLE_CLASSES                                             \
+    N_TAB_CR, 0, N_PUNCT | N_BLANK, N_DIGIT, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+
+__attribute__((target("sse4.2"))) void
+classify_sse42(const char *src, const usize blocks, BlockMasks *out) {
+  const auto low_table = _mm_setr_epi8(EPR_LOW_NIBBLE_CLASSES);
+  const auto high_table = _mm_setr_epi8(EPR_HIGH_NIBBLE_CLASSES);
+  const auto nibble = _mm_set1_epi8(0x0F);
+  const auto digit = _mm_set1_epi8(N_DIGIT);
+  const auto punct = _mm_set1_epi8(N_PUNCT);
+  const auto zero = _mm_setzero_si128();
+  for (usize block = 0; block < blocks; ++block, src += BLOCK) {
+    BlockMasks masks{};
+    u64 valid = 0;
+    for (usize part = 0; part < BLOCK / 16; ++part) {
+      const auto bytes = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(src + part * 16)
+      );
+      const auto low = _mm_and_si128(bytes, nibble);
+      const auto high = _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble);
+      const auto cls = _mm_and_si128(
+          _mm_shuffle_epi8(low_table, low), _mm_shuffle_epi8(high_table, high)
+      );
+      const auto digits = _mm_movemask_epi8(
+          _mm_cmpeq_epi8(_mm_and_si128(cls, digit), digit)
+      );
+      const auto puncts = _mm_movemask_epi8(
+          _mm_cmpeq_epi8(_mm_and_si128(cls, punct), punct)
+      );
+      const auto errors = _mm_movemask_epi8(_mm_cmpeq_epi8(cls, zero));
+      const auto shift = part * 16;
+      masks.digit |= static_cast<u64>(static_cast<u16>(digits)) << shift;
+      masks.punct |= static_cast<u64>(static_cast<u16>(puncts)) << shift;
+      valid |= static_cast<u64>(static_cast<u16>(~errors)) << shift;
+    }
+    masks.space = valid & ~(masks.digit | masks.punct);
+    out[block] = masks;
+  }
+}
+
+__attribute__((target("avx2"))) void
+classify_avx2(const char *src, const usize blocks, BlockMasks *out) {
+  // The shuffle looks up within each 128-bit lane, so both lanes hold the
+  // table.
+  const auto low_table = _mm256_setr_epi8(
+      EPR_LOW_NIBBLE_CLASSES, EPR_LOW_NIBBLE_CLASSES
+  );
+  const auto high_table = _mm256_setr_epi8(
+      EPR_HIGH_NIBBLE_CLASSES, EPR_HIGH_NIBBLE_CLASSES
+  );
+  const auto nibble = _mm256_set1_epi8(0x0F);
+  const auto digit = _mm256_set1_epi8(N_DIGIT);
+  const auto punct = _mm256_set1_epi8(N_PUNCT);
+  const auto zero = _mm256_setzero_si256();
+  for (usize block = 0; block < blocks; ++block, src += BLOCK) {
+    BlockMasks masks{};
+    u64 valid = 0;
+    for (usize part = 0; part < BLOCK / 32; ++part) {
+      const auto bytes = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(src + part * 32)
+      );
+      const auto low = _mm256_and_si256(bytes, nibble);
+      const auto high = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibble);
+      const auto cls = _mm256_and_si256(
+          _mm256_shuffle_epi8(low_table, low),
+          _mm256_shuffle_epi8(high_table, high)
+      );
+      const auto digits = _mm256_movemask_epi8(
+          _mm256_cmpeq_epi8(_mm256_and_si256(cls, digit), digit)
+      );
+      const auto puncts = _mm256_movemask_epi8(
+          _mm256_cmpeq_epi8(_mm256_and_si256(cls, punct), punct)
+      );
+      const auto errors = _mm256_movemask_epi8(_mm256_cmpeq_epi8(cls, zero));
+      const auto shift = part * 32;
+      masks.digit |= static_cast<u64>(static_cast<u32>(digits)) << shift;
+      masks.punct |= static_cast<u64>(static_cast<u32>(puncts)) << shift;
+      valid |= static_cast<u64>(~static_cast<u32>(errors)) << shift;
+    }
+    masks.space = valid & ~(masks.digit | masks.punct);
+    out[block] = masks;
+  }
+}
+
+#  undef EPR_LOW_NIBBLE_CLASSES
+#  undef EPR_HIGH_NIBBLE_CLASSES
+
+#endif // EPR_SCANNER_X86
+
+[[nodiscard]] Classify classifier(const ScanImpl impl) {
+#ifdef EPR_SCANNER_X86
+  if (impl == ScanImpl::Avx2)
+    return classify_avx2;
+  if (impl == ScanImpl::Sse42)
+    return classify_sse42;
+#endif
+  (void)impl;
+  return classify_scalar;
+}
+
+// Turns the masks of successive blocks into token spans.
+class BoundaryEmitter {
+  std::vector<SourceSpan> *spans_;
+  u64 carry_{}; // whether the byte before the block is a digit
+  u32 begin_{}; // of the digit run that `carry_` continues
+
+public:
+  explicit BoundaryEmitter(std::vector<SourceSpan> &spans): spans_(&spans) {}
+
+  // Emits the tokens of the block at `base`, of which only the first
+  // `length` bytes are input. Returns the offset of the first byte that
+  // starts no token, if any.
+  [[nodiscard]] std::optional<usize>
+  emit(const BlockMasks &masks, const usize base, const usize length) {
+    const auto in_input = length == BLOCK ? ~u64{0} : (u64{1} << length) - 1;
+    const auto error = ~(masks.digit | masks.punct | masks.space) & in_input;
+    const auto after_digit = (masks.digit << 1) | carry_;
+    const auto run_begins = masks.digit & ~after_digit;
+    // A run ends at the byte after its last digit, which may be the first
+    // byte past the input.
+    const auto run_ends = ~masks.digit & after_digit;
+    carry_ = masks.digit >> (BLOCK - 1);
+
+    for (auto events = run_begins | run_ends | masks.punct | error;
+         events != 0; events &= events - 1) {
+      const auto idx = std::countr_zero(events);
+      const auto bit = u64{1} << idx;
+      const auto pos = static_cast<u32>(base + idx);
+      if ((run_ends & bit) != 0)
+        spans_->push_back({begin_, pos});
+      if ((run_begins & bit) != 0)
+        begin_ = pos;
+      else if ((masks.punct & bit) != 0)
+        spans_->push_back({pos, pos + 1});
+      else if ((error & bit) != 0)
+        return pos;
+    }
+    return std::nullopt;
+  }
+};
+
+} // namespace
+
+ScanImpl best_scan_impl() {
+  static const auto best = [] {
+    if (is_supported(ScanImpl::Avx2))
+      return ScanImpl::Avx2;
+    if (is_supported(ScanImpl::Sse42))
+      return ScanImpl::Sse42;
+    return ScanImpl::Scalar;
+  }();
+  return best;
+}
+
+bool is_supported(const ScanImpl impl) {
+#ifdef EPR_SCANNER_X86
+  __builtin_cpu_init();
+  if (impl == ScanImpl::Avx2)
+    return __builtin_cpu_supports("avx2");
+  if (impl == ScanImpl::Sse42)
+    return __builtin_cpu_supports("sse4.2");
+#endif
+  return impl == ScanImpl::Scalar;
+}
+
+usize scan_tokens(
+    const std::string_view src, std::vector<SourceSpan> &spans,
+    const ScanImpl impl
+) {
+  const auto classify = classifier(impl);
+  spans.clear();
+  BoundaryEmitter emitter(spans);
+  std::array<BlockMasks, BATCH> masks{};
+
+  const auto full_blocks = src.size() / BLOCK;
+  for (usize first = 0; first < full_blocks; first += BATCH) {
+    const auto blocks = std::min(BATCH, full_blocks - first);
+    classify(src.data() + first * BLOCK, blocks, masks.data());
+    for (usize block = 0; block < blocks; ++block)
+      if (const auto error =
+              emitter.emit(masks[block], (first + block) * BLOCK, BLOCK))
+        return *error;
+  }
+
+  // The rest, padded with '\0', which starts no token. Even an empty rest is
+  // classified, to end a digit run that reaches the end of the input.
+  const auto base = full_blocks * BLOCK;
+  std::array<char, BLOCK> tail{};
+  if (src.size() > base)
+    std::memcpy(tail.data(), src.data() + base, src.size() - base);
+  classify(tail.data(), 1, masks.data());
+  return emitter.emit(masks[0], base, src.size() - base).value_or(src.size());
+}
+
+} // namespace epr
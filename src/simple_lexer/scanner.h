@@ -0,0 +1,36 @@
+#pragma once
+
+#ifndef EPR_SIMPLE_LEXER_SCANNER_H
+#  define EPR_SIMPLE_LEXER_SCANNER_H
+
+#  include "simple_lexer/token.h"
+#  include "util/all.h"
+
+#  include <string_view>
+#  include <vector>
+
+namespace epr {
+
+// How scan_tokens() classifies bytes: one at a time through a table, or 16
+// or 32 at a time with x86 vector instructions.
+enum class ScanImpl : u8 { Scalar, Sse42, Avx2 };
+
+// The fastest implementation this CPU runs, detected once.
+[[nodiscard]] ScanImpl best_scan_impl();
+
+[[nodiscard]] bool is_supported(ScanImpl impl);
+
+// Splits `src` into the tokens of Lexer: runs of digits and single
+// punctuators, with whitespace dropped. Bytes are classified a 64-byte block
+// at a time into bit masks, from which the token boundaries of the whole
+// block are taken with bit tricks. Replaces `spans` with those of the tokens
+// before the first byte that starts no token, and returns that byte's
+// offset, or src.size() if there is none.
+usize scan_tokens(
+    std::string_view src, std::vector<SourceSpan> &spans,
+    ScanImpl impl = best_scan_impl()
+);
+
+} // namespace epr
+
+#endif // !EPR_SIMPLE_LEXER_SCANNER_H
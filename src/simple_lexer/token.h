@@ -3,6 +3,7 @@
 #ifndef EPR_SIMPLE_LEXER_TOKEN_H
 #  define EPR_SIMPLE_LEXER_TOKEN_H
 
+#  include <cstdint>
 #  include <variant>
 #  include <vector>
 
@@ -20,8 +21,16 @@ struct Whitespace {};
 
 struct LexError {};
 
+// A token as a caller lexing on its own hands it to PushParser::feed(); Lexer
+// itself lexes straight into terminal ids.
 using Token = std::variant<Integer, Punctuator, Whitespace, LexError>;
 
+// Where a token lies in the source: bytes [begin, end).
+struct SourceSpan {
+  std::uint32_t begin{};
+  std::uint32_t end{};
+};
+
 using TokenStream = std::vector<Token>;
 
 } // namespace epr
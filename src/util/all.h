@@ -4,8 +4,13 @@
 #  define EPR_UTIL_ALL_H
 
 #  include "util/functional.h"
+#  include "util/graph.h"
+#  include "util/hash.h"
+#  include "util/hash_index.h"
 #  include "util/overloaded.h"
+#  include "util/small_vector.h"
 #  include "util/table.h"
+#  include "util/thread_pool.h"
 #  include "util/type.h"
 
 #endif // !EPR_UTIL_ALL_H
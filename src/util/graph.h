@@ -0,0 +1,81 @@
+#pragma once
+
+#ifndef EPR_UTIL_GRAPH_H
+#  define EPR_UTIL_GRAPH_H
+
+#  include "util/type.h"
+
+#  include <algorithm>
+#  include <utility>
+#  include <vector>
+
+namespace epr {
+
+// Tarjan's algorithm, iterative. A component is emitted only after every
+// component reachable from it, so dependencies are always finished first.
+inline std::vector<std::vector<u32>>
+strongly_connected_components(const std::vector<std::vector<u32>> &graph) {
+  constexpr u32 UNVISITED = ~u32{0};
+  std::vector<u32> index(graph.size(), UNVISITED);
+  std::vector<u32> low(graph.size());
+  std::vector<bool> on_stack(graph.size());
+  std::vector<u32> stack{};
+  std::vector<std::pair<u32, usize>> call_stack{};
+  std::vector<std::vector<u32>> components{};
+  u32 counter = 0;
+
+  auto visit = [&](const u32 v) {
+    index[v] = low[v] = counter++;
+    stack.push_back(v);
+    on_stack[v] = true;
+    call_stack.emplace_back(v, 0);
+  };
+
+  for (u32 root = 0; root < graph.size(); ++root) {
+    if (index[root] != UNVISITED)
+      continue;
+    visit(root);
+    while (!call_stack.empty()) {
+      const u32 v = call_stack.back().first;
+      if (auto &edge = call_stack.back().second; edge < graph[v].size()) {
+        const u32 w = graph[v][edge++];
+        if (index[w] == UNVISITED)
+          visit(w);
+        else if (on_stack[w])
+          low[v] = std::min(low[v], index[w]);
+        continue;
+      }
+
+      call_stack.pop_back();
+      if (!call_stack.empty()) {
+        const u32 parent = call_stack.back().first;
+        low[parent] = std::min(low[parent], low[v]);
+      }
+      if (low[v] != index[v])
+        continue;
+      auto &component = components.emplace_back();
+      u32 w;
+      do {
+        w = stack.back();
+        stack.pop_back();
+        on_stack[w] = false;
+        component.push_back(w);
+      } while (w != v);
+    }
+  }
+  return components;
+}
+
+inline bool is_recursive(
+    const std::vector<u32> &component,
+    const std::vector<std::vector<u32>> &graph
+) {
+  if (component.size() > 1)
+    return true;
+  const auto &edges = graph[component.front()];
+  return std::ranges::find(edges, component.front()) != edges.end();
+}
+
+} // namespace epr
+
+#endif // !EPR_UTIL_GRAPH_H
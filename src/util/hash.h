@@ -0,0 +1,47 @@
+#pragma once
+
+#ifndef EPR_UTIL_HASH_H
+#  define EPR_UTIL_HASH_H
+
+#  include "util/type.h"
+
+#  include <span>
+#  include <string_view>
+
+namespace epr {
+
+// Finalizer of splitmix64.
+constexpr u64 mix(u64 x) {
+  x ^= x >> 30;
+  x *= 0xBF58'476D'1CE4'E5B9;
+  x ^= x >> 27;
+  x *= 0x94D0'49BB'1331'11EB;
+  x ^= x >> 31;
+  return x;
+}
+
+constexpr u64 hash_combine(const u64 seed, const u64 value) {
+  return mix(seed + 0x9E37'79B9'7F4A'7C15 + value);
+}
+
+constexpr u64 hash_words(const std::span<const u64> words) {
+  u64 ret = words.size();
+  for (const auto word : words)
+    ret = hash_combine(ret, word);
+  return ret;
+}
+
+// 64-bit FNV-1a. Unlike std::hash it is fixed across runs and platforms, so
+// it can key things kept on disk. `seed` chains several calls.
+constexpr u64
+fnv1a(const std::string_view bytes, u64 seed = 0xCBF2'9CE4'8422'2325) {
+  for (const auto byte : bytes) {
+    seed ^= static_cast<u8>(byte);
+    seed *= 0x100'0000'01B3;
+  }
+  return seed;
+}
+
+} // namespace epr
+
+#endif // !EPR_UTIL_HASH_H
@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef EPR_UTIL_HASH_INDEX_H
+#  define EPR_UTIL_HASH_INDEX_H
+
+#  include "util/type.h"
+
+#  include <optional>
+#  include <vector>
+
+namespace epr {
+
+// Open-addressing index from a precomputed hash to a dense id. Keys live with
+// the caller, who supplies the equality test on lookup; the index only keeps
+// (hash, id) pairs. Linear probing, capacity kept a power of two at most half
+// full.
+class HashIndex {
+  static constexpr u32 EMPTY = ~u32{0};
+
+  struct Slot {
+    u64 hash{};
+    u32 id{EMPTY};
+  };
+
+  std::vector<Slot> slots_ = std::vector<Slot>(16);
+  usize size_{};
+
+  void grow() {
+    auto old_slots = std::move(slots_);
+    slots_.assign(old_slots.size() * 2, Slot{});
+    for (const auto &slot : old_slots)
+      if (slot.id != EMPTY)
+        place(slot);
+  }
+
+  void place(const Slot &slot) {
+    const usize mask = slots_.size() - 1;
+    for (usize pos = slot.hash & mask;; pos = (pos + 1) & mask)
+      if (slots_[pos].id == EMPTY) {
+        slots_[pos] = slot;
+        return;
+      }
+  }
+
+public:
+  HashIndex() = default;
+
+  template<typename Eq>
+  [[nodiscard]] std::optional<u32> find(const u64 hash, Eq &&eq) const {
+    const usize mask = slots_.size() - 1;
+    for (usize pos = hash & mask; slots_[pos].id != EMPTY;
+         pos = (pos + 1) & mask)
+      if (slots_[pos].hash == hash && eq(slots_[pos].id))
+        return slots_[pos].id;
+    return std::nullopt;
+  }
+
+  // Does not check for an existing equal key.
+  void insert(const u64 hash, const u32 id) {
+    if (2 * (size_ + 1) > slots_.size())
+      grow();
+    place({hash, id});
+    ++size_;
+  }
+
+  [[nodiscard]] usize size() const {
+    return size_;
+  }
+};
+
+} // namespace epr
+
+#endif // !EPR_UTIL_HASH_INDEX_H
@@ -0,0 +1,222 @@
+#pragma once
+
+#ifndef EPR_UTIL_SMALL_VECTOR_H
+#  define EPR_UTIL_SMALL_VECTOR_H
+
+#  include "util/type.h"
+
+#  include <algorithm>
+#  include <cstddef>
+#  include <memory>
+#  include <new>
+#  include <utility>
+
+namespace epr {
+
+// A vector whose first N elements live inside the object, so that it only
+// goes to the heap once it outgrows them. Storage never shrinks: clear() and
+// resize() keep the capacity for the next use. Pointers into it are
+// invalidated by growth and by moves of an inline vector.
+template <typename T, usize N>
+class SmallVector {
+  static_assert(N > 0);
+
+  T *data_;
+  usize size_{};
+  usize capacity_{N};
+  alignas(T) std::byte inline_[N * sizeof(T)];
+
+  [[nodiscard]] bool is_inline() const {
+    return data_ == reinterpret_cast<const T *>(inline_);
+  }
+
+  void grow(const usize min_capacity) {
+    const auto capacity = std::max(min_capacity, capacity_ * 2);
+    auto *const data = std::allocator<T>{}.allocate(capacity);
+    std::uninitialized_move(data_, data_ + size_, data);
+    std::destroy(data_, data_ + size_);
+    release();
+    data_ = data;
+    capacity_ = capacity;
+  }
+
+  void release() {
+    if (!is_inline())
+      std::allocator<T>{}.deallocate(data_, capacity_);
+  }
+
+public:
+  SmallVector(): data_(reinterpret_cast<T *>(inline_)) {}
+
+  SmallVector(const SmallVector &rhs): SmallVector() {
+    reserve(rhs.size_);
+    std::uninitialized_copy(rhs.begin(), rhs.end(), data_);
+    size_ = rhs.size_;
+  }
+
+  // Takes over a heap buffer, and moves inline elements one by one.
+  SmallVector(SmallVector &&rhs) noexcept: SmallVector() {
+    if (rhs.is_inline()) {
+      std::uninitialized_move(rhs.begin(), rhs.end(), data_);
+      size_ = rhs.size_;
+      rhs.clear();
+      return;
+    }
+    data_ = std::exchange(rhs.data_, reinterpret_cast<T *>(rhs.inline_));
+    size_ = std::exchange(rhs.size_, 0);
+    capacity_ = std::exchange(rhs.capacity_, N);
+  }
+
+  SmallVector &operator=(const SmallVector &rhs) {
+    if (this != &rhs) {
+      clear();
+      reserve(rhs.size_);
+      std::uninitialized_copy(rhs.begin(), rhs.end(), data_);
+      size_ = rhs.size_;
+    }
+    return *this;
+  }
+
+  SmallVector &operator=(SmallVector &&rhs) noexcept {
+    if (this == &rhs)
+      return *this;
+    clear();
+    if (rhs.is_inline()) {
+      // Any buffer of ours holds at least N.
+      std::uninitialized_move(rhs.begin(), rhs.end(), data_);
+      size_ = rhs.size_;
+      rhs.clear();
+      return *this;
+    }
+    release();
+    data_ = std::exchange(rhs.data_, reinterpret_cast<T *>(rhs.inline_));
+    size_ = std::exchange(rhs.size_, 0);
+    capacity_ = std::exchange(rhs.capacity_, N);
+    return *this;
+  }
+
+  ~SmallVector() {
+    clear();
+    release();
+  }
+
+  [[nodiscard]] usize size() const {
+    return size_;
+  }
+
+  [[nodiscard]] bool empty() const {
+    return size_ == 0;
+  }
+
+  [[nodiscard]] usize capacity() const {
+    return capacity_;
+  }
+
+  [[nodiscard]] T *data() {
+    return data_;
+  }
+
+  [[nodiscard]] const T *data() const {
+    return data_;
+  }
+
+  [[nodiscard]] T *begin() {
+    return data_;
+  }
+
+  [[nodiscard]] const T *begin() const {
+    return data_;
+  }
+
+  [[nodiscard]] T *end() {
+    return data_ + size_;
+  }
+
+  [[nodiscard]] const T *end() const {
+    return data_ + size_;
+  }
+
+  [[nodiscard]] T &operator[](const usize idx) {
+    return data_[idx];
+  }
+
+  [[nodiscard]] const T &operator[](const usize idx) const {
+    return data_[idx];
+  }
+
+  [[nodiscard]] T &front() {
+    return data_[0];
+  }
+
+  [[nodiscard]] const T &front() const {
+    return data_[0];
+  }
+
+  [[nodiscard]] T &back() {
+    return data_[size_ - 1];
+  }
+
+  [[nodiscard]] const T &back() const {
+    return data_[size_ - 1];
+  }
+
+  void reserve(const usize capacity) {
+    if (capacity > capacity_)
+      grow(capacity);
+  }
+
+  template <typename... Args>
+  T &emplace_back(Args &&...args) {
+    if (size_ == capacity_) {
+      // `args` may refer into the old storage.
+      T value(std::forward<Args>(args)...);
+      grow(size_ + 1);
+      return *new (data_ + size_++) T(std::move(value));
+    }
+    return *new (data_ + size_++) T(std::forward<Args>(args)...);
+  }
+
+  void push_back(const T &value) {
+    emplace_back(value);
+  }
+
+  void push_back(T &&value) {
+    emplace_back(std::move(value));
+  }
+
+  void pop_back() {
+    std::destroy_at(data_ + --size_);
+  }
+
+  // Default-constructs the new elements.
+  void resize(const usize size) {
+    if (size < size_) {
+      std::destroy(data_ + size, data_ + size_);
+    } else {
+      reserve(size);
+      std::uninitialized_value_construct(data_ + size_, data_ + size);
+    }
+    size_ = size;
+  }
+
+  void assign(const usize size, const T &value) {
+    const T copy(value); // `value` may be one of ours
+    clear();
+    reserve(size);
+    std::uninitialized_fill(data_, data_ + size, copy);
+    size_ = size;
+  }
+
+  void clear() {
+    std::destroy(data_, data_ + size_);
+    size_ = 0;
+  }
+
+  [[nodiscard]] bool operator==(const SmallVector &rhs) const {
+    return std::equal(begin(), end(), rhs.begin(), rhs.end());
+  }
+};
+
+} // namespace epr
+
+#endif // !EPR_UTIL_SMALL_VECTOR_H
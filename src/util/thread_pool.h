@@ -0,0 +1,166 @@
+#pragma once
+
+#ifndef EPR_UTIL_THREAD_POOL_H
+#  define EPR_UTIL_THREAD_POOL_H
+
+#  include "util/type.h"
+
+#  include <algorithm>
+#  include <condition_variable>
+#  include <deque>
+#  include <exception>
+#  include <functional>
+#  include <memory>
+#  include <mutex>
+#  include <optional>
+#  include <thread>
+#  include <utility>
+#  include <vector>
+
+namespace epr {
+
+// Fork-join pool for data-parallel loops. parallel_for() deals chunks of the
+// index range round-robin onto per-worker deques; a worker takes from the
+// back of its own deque and, once that is empty, steals from the front of the
+// others. The calling thread works as the last worker, so a pool of size 1
+// runs everything inline.
+class ThreadPool {
+  using Chunk = std::pair<usize, usize>;
+
+  struct Queue {
+    std::mutex mutex{};
+    std::deque<Chunk> chunks{};
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues_{};
+  std::vector<std::thread> threads_{};
+
+  std::mutex mutex_{};
+  std::condition_variable wake_{};
+  std::condition_variable done_{};
+  u64 generation_{};
+  usize pending_{};
+  bool stop_{};
+  std::function<void(usize, usize)> body_{};
+  std::exception_ptr error_{};
+
+  std::optional<Chunk> take(const usize worker) {
+    { // own deque, newest first
+      auto &queue = *queues_[worker];
+      const std::lock_guard lock(queue.mutex);
+      if (!queue.chunks.empty()) {
+        const auto chunk = queue.chunks.back();
+        queue.chunks.pop_back();
+        return chunk;
+      }
+    }
+    for (usize offset = 1; offset < queues_.size(); ++offset) {
+      auto &victim = *queues_[(worker + offset) % queues_.size()];
+      const std::lock_guard lock(victim.mutex);
+      if (!victim.chunks.empty()) {
+        const auto chunk = victim.chunks.front();
+        victim.chunks.pop_front();
+        return chunk;
+      }
+    }
+    return std::nullopt;
+  }
+
+  void drain(const usize worker) {
+    while (const auto chunk = take(worker)) {
+      try {
+        for (usize idx = chunk->first; idx < chunk->second; ++idx)
+          body_(idx, worker);
+      } catch (...) {
+        const std::lock_guard lock(mutex_);
+        if (!error_)
+          error_ = std::current_exception();
+      }
+      const std::lock_guard lock(mutex_);
+      if (--pending_ == 0)
+        done_.notify_all();
+    }
+  }
+
+  void run(const usize worker) {
+    u64 seen = 0;
+    while (true) {
+      {
+        std::unique_lock lock(mutex_);
+        wake_.wait(lock, [&] {
+          return stop_ || generation_ != seen;
+        });
+        if (stop_)
+          return;
+        seen = generation_;
+      }
+      drain(worker);
+    }
+  }
+
+public:
+  explicit ThreadPool(const usize thread_count = 1) {
+    const usize count = std::max<usize>(thread_count, 1);
+    for (usize idx = 0; idx < count; ++idx)
+      queues_.push_back(std::make_unique<Queue>());
+    for (usize idx = 0; idx + 1 < count; ++idx)
+      threads_.emplace_back([this, idx] {
+        run(idx);
+      });
+  }
+
+  ThreadPool(const ThreadPool &rhs) = delete;
+
+  ThreadPool &operator=(const ThreadPool &rhs) = delete;
+
+  ~ThreadPool() {
+    {
+      const std::lock_guard lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &thread : threads_)
+      thread.join();
+  }
+
+  [[nodiscard]] usize size() const {
+    return queues_.size();
+  }
+
+  // Calls f(idx, worker) for every idx in [0, count), where worker in
+  // [0, size()) identifies the calling worker. Rethrows the first exception
+  // thrown by f once every index has been handled.
+  template<typename F>
+  void parallel_for(const usize count, F &&f) {
+    if (count == 0)
+      return;
+    const usize chunk_size = std::max<usize>(1, count / (size() * 8));
+    {
+      const std::lock_guard lock(mutex_);
+      body_ = std::ref(f);
+      error_ = nullptr;
+      pending_ = 0;
+      for (usize begin = 0; begin < count; begin += chunk_size) {
+        auto &queue = *queues_[pending_ % size()];
+        const std::lock_guard queue_lock(queue.mutex);
+        queue.chunks.emplace_back(begin, std::min(begin + chunk_size, count));
+        ++pending_;
+      }
+      ++generation_;
+    }
+    wake_.notify_all();
+
+    drain(size() - 1);
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [&] {
+      return pending_ == 0;
+    });
+    body_ = nullptr;
+    if (error_)
+      std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+};
+
+} // namespace epr
+
+#endif // !EPR_UTIL_THREAD_POOL_H
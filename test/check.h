@@ -0,0 +1,23 @@
+#pragma once
+
+#ifndef EPR_TEST_CHECK_H
+#  define EPR_TEST_CHECK_H
+
+#  include <iostream>
+#  include <string_view>
+
+namespace epr::test {
+
+// Checks failed so far; a test's main() returns whether there were any.
+inline int failures = 0;
+
+inline void check(const bool ok, const std::string_view what) {
+  if (ok)
+    return;
+  ++failures;
+  std::cerr << "FAILED: " << what << '\n';
+}
+
+} // namespace epr::test
+
+#endif // !EPR_TEST_CHECK_H
@@ -0,0 +1,56 @@
+// Number values from Lexer::lex_terminals(), with and without the
+// arbitrary-width fallback for numbers too wide for 64 bits.
+
+#include "check.h"
+
+#include "simple_lexer/lexer.h"
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+using namespace epr;
+using epr::test::check;
+
+int main() {
+  TerminalMap map{};
+  map.integer = 2;
+  map.punctuator['+'] = 3;
+  // 2^64 and 2^128 + 5 around a number that fits.
+  constexpr std::string_view src =
+      "18446744073709551616 + 42 + 340282366920938463463374607431768211461";
+
+  Lexer narrow{};
+  narrow.load_src(src);
+  check(
+      std::ranges::equal(narrow.lex_terminals(map), std::vector{2, 3, 2, 3, 2}),
+      "terminal ids"
+  );
+  check(!narrow.values()[0] && !narrow.values()[4], "too wide for values()");
+  check(narrow.values()[2] == 42, "value of 42");
+  check(narrow.wide_value(0).empty(), "wide values are not kept by default");
+
+  Lexer wide(LexerOptions{.keep_wide_integers = true});
+  for (int round = 0; round < 2; ++round) {
+    wide.load_src(src);
+    (void)wide.lex_terminals(map);
+    check(
+        std::ranges::equal(wide.wide_value(0), std::vector<u64>{0, 1}),
+        "wide value of 2^64"
+    );
+    check(
+        std::ranges::equal(wide.wide_value(4), std::vector<u64>{5, 0, 1}),
+        "wide value of 2^128 + 5"
+    );
+    check(wide.values()[2] == 42, "value of 42 beside wide ones");
+    check(
+        wide.wide_value(1).empty() && wide.wide_value(2).empty(),
+        "no wide value for other tokens"
+    );
+  }
+
+  wide.load_src(std::string_view("1 + 2"));
+  (void)wide.lex_terminals(map);
+  check(wide.wide_value(0).empty(), "wide values of an earlier source go");
+  return epr::test::failures != 0;
+}
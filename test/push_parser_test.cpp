@@ -0,0 +1,149 @@
+// PushParser, fed tokens in chunks of any size, gives the same outcome and
+// error positions as ParserTables::recognize() on the same line, and throws
+// on a lex error where Lexer::lex_terminals() does.
+
+#include "check.h"
+
+#include "parser/parser.h"
+#include "parser/push_parser.h"
+#include "simple_lexer/lexer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <format>
+#include <memory>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace epr;
+using epr::test::check;
+
+namespace {
+
+constexpr std::string_view grammar = R"(E
+E -> E + T | E - T | T
+T -> T * F | T / F | F
+F -> ( E ) | n)";
+
+// The tokens a caller lexing on its own would hand to PushParser.
+TokenStream tokenize(const std::string_view src) {
+  TokenStream ret{};
+  for (usize idx = 0; idx < src.size(); ++idx) {
+    const auto c = src[idx];
+    if (isdigit(c)) {
+      while (idx + 1 < src.size() && isdigit(src[idx + 1]))
+        ++idx;
+      ret.emplace_back(Integer{});
+    } else if (c == ' ')
+      ret.emplace_back(Whitespace{});
+    else if (std::string_view("+-*/()").contains(c))
+      ret.emplace_back(Punctuator(c));
+    else
+      ret.emplace_back(LexError{});
+  }
+  return ret;
+}
+
+// What recognize() or a PushParser made of a line; `error` is the message
+// of what it threw, if anything.
+struct Outcome {
+  ParseResult result{};
+  std::string error{};
+
+  bool operator==(const Outcome &other) const {
+    return result.accepted == other.result.accepted &&
+           std::ranges::equal(
+               result.error_positions, other.result.error_positions
+           ) &&
+           error == other.error;
+  }
+};
+
+Outcome recognize(const ParserTables &tables, const std::string_view src) {
+  Lexer lexer{};
+  ParseContext<> context{};
+  lexer.load_src(src);
+  try {
+    return {tables.recognize(lexer.lex_terminals(tables.terminals), context)};
+  } catch (const std::runtime_error &e) {
+    return {{}, e.what()};
+  }
+}
+
+Outcome push(
+    PushParser &parser, const std::string_view src, std::mt19937 &rng
+) {
+  const auto tokens = tokenize(src);
+  parser.reset();
+  try {
+    for (usize idx = 0; idx < tokens.size();) {
+      const auto count = std::min<usize>(tokens.size() - idx, rng() % 4);
+      parser.feed(std::span(tokens).subspan(idx, count));
+      idx += count;
+    }
+    return {parser.finish()};
+  } catch (const std::runtime_error &e) {
+    return {{}, e.what()};
+  }
+}
+
+} // namespace
+
+int main() {
+  ParserOptions options{};
+  options.verbose = false;
+  for (const bool eliminate_unit_rules : {false, true})
+    for (const bool compress : {false, true}) {
+      options.eliminate_unit_rules = eliminate_unit_rules;
+      options.compress = compress;
+      const auto what = std::format(
+          "unit rules eliminated {}, compress {}", eliminate_unit_rules,
+          compress
+      );
+      const auto tables = std::make_shared<const ParserTables>(
+          Grammar::from_str(grammar), options
+      );
+      PushParser parser(tables);
+      std::mt19937 rng(0);
+
+      for (const auto src : {"1 + 2 * 3", "(1 + 2", "1 + * 2 )", "", "1 2"}) {
+        const auto expected = recognize(*tables, src);
+        check(
+            push(parser, src, rng) == expected,
+            std::format("'{}', {}", src, what)
+        );
+      }
+      check(recognize(*tables, "1 + 2 * 3").result.accepted, "accepts");
+      check(
+          std::ranges::equal(
+              recognize(*tables, "(1 + 2").result.error_positions,
+              std::vector<usize>{4}
+          ),
+          "error at the end of the input"
+      );
+
+      const auto lex_error = push(parser, "1 + 2 # 3", rng);
+      check(
+          lex_error == recognize(*tables, "1 + 2 # 3") &&
+              lex_error.error == "Lex error",
+          "lex error, " + what
+      );
+
+      // Random lines over the grammar's tokens, with a stray character now
+      // and then.
+      constexpr std::string_view alphabet = "12+-*/()  #";
+      usize mismatches = 0;
+      for (int round = 0; round < 20000; ++round) {
+        std::string src{};
+        for (auto length = rng() % 12; length != 0; --length)
+          src.push_back(alphabet[rng() % (alphabet.size() - (round % 2))]);
+        mismatches += push(parser, src, rng) != recognize(*tables, src);
+      }
+      check(mismatches == 0, "random lines, " + what);
+    }
+  return epr::test::failures != 0;
+}
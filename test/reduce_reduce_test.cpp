@@ -0,0 +1,84 @@
+// Reduce/reduce conflicts go to the production declared first, whatever the
+// names of the symbols, and a parse that reduces by empty rules in a circle
+// fails instead of growing its stack without end.
+
+#include "check.h"
+
+#include "parser/parser.h"
+#include "parser/push_parser.h"
+
+#include <format>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+using namespace epr;
+using epr::test::check;
+
+namespace {
+
+struct Outcome {
+  bool recognized{};
+  bool evaluated{};
+  bool pushed{};
+};
+
+Outcome parse(
+    const std::string_view grammar, const ParserOptions &options,
+    const std::vector<std::string_view> &names
+) {
+  const auto tables = std::make_shared<const ParserTables>(
+      Grammar::from_str(grammar), options
+  );
+  std::vector<u32> input{};
+  for (const auto name : names)
+    input.push_back(tables->grammar.symbols.find(std::string(name))->id);
+
+  Outcome ret{};
+  ParseContext<> context{};
+  ret.recognized = tables->recognize(input, context).accepted;
+  ParseContext<int> value_context{};
+  ret.evaluated =
+      tables->evaluate(input, SemanticActions<int>{}, value_context)
+          .has_value();
+  PushParser push(tables);
+  for (const auto id : input)
+    push.feed(Symbol(id, Symbol::Terminator));
+  ret.pushed = push.finish().accepted;
+  return ret;
+}
+
+} // namespace
+
+int main() {
+  // On 'b' after an 'a', both A -> ε and S -> ε may reduce. S -> ε is
+  // declared first and is the one that lets 'b' be shifted; A sorts first
+  // by name, which must not matter.
+  constexpr std::string_view s_first = "S\nS -> A S b | ε\nA -> a | ε";
+  // The same with A -> ε declared first, which reduces forever.
+  constexpr std::string_view a_first = "S\nA -> a | ε\nS -> A S b | ε";
+
+  for (const auto construction :
+       {Construction::Lr1, Construction::Lalr1, Construction::MinimalLr1})
+    for (const bool compress : {false, true}) {
+      ParserOptions options{};
+      options.construction = construction;
+      options.compress = compress;
+      options.verbose = false;
+      const auto what = std::format(
+          "construction {}, compress {}", static_cast<int>(construction),
+          compress
+      );
+
+      const auto valid = parse(s_first, options, {"a", "b"});
+      check(valid.recognized, "recognize 'a b', " + what);
+      check(valid.evaluated, "evaluate 'a b', " + what);
+      check(valid.pushed, "push 'a b', " + what);
+
+      const auto looping = parse(a_first, options, {"a", "b"});
+      check(!looping.recognized, "recognize stops its loop, " + what);
+      check(!looping.evaluated, "evaluate stops its loop, " + what);
+      check(!looping.pushed, "push stops its loop, " + what);
+    }
+  return epr::test::failures != 0;
+}
@@ -0,0 +1,74 @@
+// A table from make_static_table() matches the one ParsingTable builds at
+// run time from the same grammar, cell for cell, including where a name's
+// precedence is declared twice and only the later declaration counts.
+
+#include "check.h"
+
+#include "parser/parser.h"
+#include "parser/static_table.h"
+
+#include <algorithm>
+#include <format>
+#include <string_view>
+
+using namespace epr;
+using epr::test::check;
+
+namespace {
+
+template <const std::string_view &Text>
+void compare(const std::string_view what) {
+  static constexpr auto compiled = make_static_table<Text>();
+  ParserOptions options{};
+  options.verbose = false;
+  const ParserTables tables(Grammar::from_str(Text), options);
+  const auto built = tables.view;
+  const auto view = compiled.view();
+
+  check(
+      view.rows == built.rows && view.cols == built.cols &&
+          view.terminal_count == built.terminal_count,
+      std::format("{}: sizes", what)
+  );
+  check(
+      std::ranges::equal(view.cells, built.cells),
+      std::format("{}: cells", what)
+  );
+  check(
+      std::ranges::equal(view.default_reductions, built.default_reductions),
+      std::format("{}: default reductions", what)
+  );
+  check(
+      std::ranges::equal(compiled.rule_lhs, tables.rule_lhs) &&
+          std::ranges::equal(compiled.rule_length, tables.rule_length),
+      std::format("{}: rules", what)
+  );
+}
+
+constexpr std::string_view expressions = R"(E
+E -> E + T | E - T | T
+T -> T * F | T / F | F
+F -> ( E ) | n)";
+
+// '+' is declared again after '*', so it binds tighter than '*'.
+constexpr std::string_view redeclared = R"(E
+%left +
+%left *
+%left +
+E -> E + E | E * E | n)";
+
+// The tag of a %prec redeclared from %nonassoc to %right.
+constexpr std::string_view redeclared_tag = R"(E
+%nonassoc NEG
+%left - *
+%right NEG
+E -> E - E | E * E | - E %prec NEG | - E | n)";
+
+} // namespace
+
+int main() {
+  compare<expressions>("expressions");
+  compare<redeclared>("redeclared precedence");
+  compare<redeclared_tag>("redeclared %prec tag");
+  return epr::test::failures != 0;
+}
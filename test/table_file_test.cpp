@@ -0,0 +1,114 @@
+// A cached table file whose cells point at states, rules or columns that do
+// not exist is refused when mapped, and ParserTables builds the table anew.
+
+#include "check.h"
+
+#include "parser/parser.h"
+#include "parser/table_file.h"
+
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace epr;
+using epr::test::check;
+
+namespace {
+
+constexpr std::string_view grammar = R"(E
+E -> E + T | T
+T -> T * F | F
+F -> ( E ) | n)";
+
+std::string read_file(const std::filesystem::path &path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), {}};
+}
+
+void write_file(const std::filesystem::path &path, const std::string &bytes) {
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+}
+
+// `bytes` with the word at `idx` of the cells, or of the default reductions
+// after them, replaced by `action`.
+std::string with_cell(
+    std::string bytes, const usize idx, const PackedAction action
+) {
+  TableFileHeader header{};
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  const usize words_before = (header.symbol_count + 1ull) +
+                             header.rule_count + (header.rule_count + 1ull) +
+                             header.rhs_count;
+  std::memcpy(
+      bytes.data() + sizeof(header) + (words_before + idx) * sizeof(u32),
+      &action.bits, sizeof(u32)
+  );
+  return bytes;
+}
+
+} // namespace
+
+int main() {
+  const auto dir = std::filesystem::temp_directory_path() /
+                   std::format("epr_table_file_test.{}", getpid());
+  ParserOptions options{};
+  options.cache_dir = dir;
+  options.verbose = false;
+  {
+    const ParserTables built(Grammar::from_str(grammar), options);
+    check(!built.mapped, "first run builds");
+  }
+  const auto path = *std::filesystem::directory_iterator(dir);
+  const auto good = read_file(path);
+
+  TableFileHeader header{};
+  std::memcpy(&header, good.data(), sizeof(header));
+  const auto key = header.key;
+  const auto cells = usize{header.rows} * header.cols;
+  using Kind = PackedAction::Kind;
+  // Accept is the last kind; the one after it is not a kind at all.
+  PackedAction unknown{};
+  unknown.bits = static_cast<u32>(Kind::Accept) + 1;
+  // Column 2 is a terminal and the last column a non-terminal.
+  const std::vector<std::pair<std::string, std::string>> damaged{
+      {"shift past the last state",
+       with_cell(good, 2, {Kind::Shift, header.rows})},
+      {"reduce by a missing rule",
+       with_cell(good, 2, {Kind::Reduce, header.rule_count})},
+      {"goto in a terminal column", with_cell(good, 2, {Kind::Goto, 0})},
+      {"shift in a non-terminal column",
+       with_cell(good, header.cols - 1, {Kind::Shift, 0})},
+      {"unknown kind", with_cell(good, 2, unknown)},
+      {"default that shifts", with_cell(good, cells, {Kind::Shift, 0})},
+  };
+
+  check(MappedTable(path, key).table().rows == header.rows, "maps when intact");
+  for (const auto &[what, bytes] : damaged) {
+    write_file(path, bytes);
+    bool refused = false;
+    try {
+      MappedTable mapped(path, key);
+    } catch (const std::runtime_error &) {
+      refused = true;
+    }
+    check(refused, "refuses " + what);
+
+    const ParserTables rebuilt(Grammar::from_str(grammar), options);
+    ParseContext<> context{};
+    const std::vector<u32> input{rebuilt.terminals.integer};
+    check(
+        !rebuilt.mapped && rebuilt.recognize(input, context).accepted,
+        "rebuilds after " + what
+    );
+  }
+  std::filesystem::remove_all(dir);
+  return epr::test::failures != 0;
+}